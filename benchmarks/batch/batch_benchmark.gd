@@ -0,0 +1,69 @@
+# draws the same grid of VGPaths once as separate canvas items and once
+# through a VGBatch, and prints the draw calls and frame time of each. needs
+# a rendering driver (not --headless), and an engine built with this module:
+#
+#   godot --path modules/svg_mesh/benchmarks/batch -s batch_benchmark.gd -- [paths=2000] [frames=300]
+extends SceneTree
+
+var paths := 2000
+var frames := 300
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		var kv := arg.split("=")
+		if kv.size() != 2:
+			continue
+		if kv[0] == "paths":
+			paths = int(kv[1])
+		elif kv[0] == "frames":
+			frames = int(kv[1])
+	_run()
+
+
+func _run() -> void:
+	print("paths %d, frames %d" % [paths, frames])
+	await _measure(false)
+	await _measure(true)
+	quit()
+
+
+func _make_scene(batched: bool) -> Node2D:
+	var holder: Node2D = VGBatch.new() if batched else Node2D.new()
+	var renderer := VGMeshRenderer.new()
+	var columns := int(ceil(sqrt(paths)))
+	for i in paths:
+		# a default VGPath is an ellipse of radius 100.
+		var path := VGPath.new()
+		path.renderer = renderer
+		path.position = Vector2(i % columns, i / columns) * 24.0 + Vector2(12, 12)
+		path.scale = Vector2(0.1, 0.1)
+		var color := VGColor.new()
+		color.color = Color.from_hsv(float(i) / paths, 0.8, 0.9)
+		path.fill_color = color
+		holder.add_child(path)
+	return holder
+
+
+func _measure(batched: bool) -> void:
+	var scene := _make_scene(batched)
+	root.add_child(scene)
+
+	# the first frames tessellate; only the steady state is measured.
+	for i in 10:
+		await process_frame
+
+	var draw_calls := 0.0
+	var start := Time.get_ticks_usec()
+	for i in frames:
+		await process_frame
+		draw_calls += Performance.get_monitor(Performance.RENDER_TOTAL_DRAW_CALLS_IN_FRAME)
+	var elapsed := Time.get_ticks_usec() - start
+
+	print("%s: %.1f draw calls/frame, %.3f ms/frame" % [
+			"batched" if batched else "unbatched",
+			draw_calls / frames,
+			elapsed / 1000.0 / frames])
+
+	scene.free()
+	await process_frame
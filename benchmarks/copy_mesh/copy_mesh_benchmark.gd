@@ -0,0 +1,109 @@
+# times the two ways copy_mesh (utils.cpp) turns tove's triangles into an
+# ArrayMesh surface, on the same planar arrays of 10k to 1M vertices: the
+# planar path (constant normals and tangents, indices as they are) and the
+# SurfaceTool path it replaced (create_from_triangle_arrays,
+# generate_normals, generate_tangents, commit_to_arrays). the arrays carry
+# UVs, as a paint mesh's do, so that generate_tangents has work to do.
+# runs headless, with an engine built with this module or without:
+#
+#   godot --headless --path modules/svg_mesh/benchmarks/copy_mesh -s copy_mesh_benchmark.gd -- [runs=5]
+extends SceneTree
+
+var runs := 5
+
+
+func _initialize() -> void:
+	for arg in OS.get_cmdline_user_args():
+		var kv := arg.split("=")
+		if kv.size() == 2 and kv[0] == "runs":
+			runs = int(kv[1])
+	for n in [10000, 100000, 1000000]:
+		_measure(n)
+	quit()
+
+
+# a grid of about n vertices in the z = 0 plane, triangulated, with the
+# vertex, color, uv and index arrays copy_mesh builds.
+func _make_arrays(n: int) -> Array:
+	var side := int(ceil(sqrt(n)))
+	var vertices := PackedVector3Array()
+	var colors := PackedColorArray()
+	var uvs := PackedVector2Array()
+	vertices.resize(side * side)
+	colors.resize(side * side)
+	uvs.resize(side * side)
+	for y in side:
+		for x in side:
+			var i := y * side + x
+			vertices[i] = Vector3(x * 0.001, y * -0.001, 0)
+			colors[i] = Color(float(x) / side, float(y) / side, 0.5)
+			uvs[i] = Vector2(float(x) / side, 0.5)
+
+	var indices := PackedInt32Array()
+	indices.resize((side - 1) * (side - 1) * 6)
+	var k := 0
+	for y in side - 1:
+		for x in side - 1:
+			var i := y * side + x
+			indices[k] = i
+			indices[k + 1] = i + 1
+			indices[k + 2] = i + side
+			indices[k + 3] = i + 1
+			indices[k + 4] = i + side + 1
+			indices[k + 5] = i + side
+			k += 6
+
+	var arrays := []
+	arrays.resize(Mesh.ARRAY_MAX)
+	arrays[Mesh.ARRAY_VERTEX] = vertices
+	arrays[Mesh.ARRAY_COLOR] = colors
+	arrays[Mesh.ARRAY_TEX_UV] = uvs
+	arrays[Mesh.ARRAY_INDEX] = indices
+	return arrays
+
+
+# add_planar_normals() and the planar branch of copy_mesh.
+func _planar(arrays: Array) -> ArrayMesh:
+	var n: int = arrays[Mesh.ARRAY_VERTEX].size()
+	var normals := PackedVector3Array()
+	normals.resize(n)
+	normals.fill(Vector3(0, 0, 1))
+	var tangents := PackedColorArray()
+	tangents.resize(n)
+	tangents.fill(Color(1, 0, 0, 1))
+
+	var out := arrays.duplicate()
+	out[Mesh.ARRAY_NORMAL] = normals
+	out[Mesh.ARRAY_TANGENT] = tangents.to_byte_array().to_float32_array()
+	var mesh := ArrayMesh.new()
+	mesh.add_surface_from_arrays(Mesh.PRIMITIVE_TRIANGLES, out)
+	return mesh
+
+
+func _surface_tool(arrays: Array) -> ArrayMesh:
+	var st := SurfaceTool.new()
+	st.create_from_arrays(arrays)
+	st.generate_normals()
+	st.generate_tangents()
+	var mesh := ArrayMesh.new()
+	mesh.add_surface_from_arrays(Mesh.PRIMITIVE_TRIANGLES, st.commit_to_arrays())
+	return mesh
+
+
+func _best_msec(arrays: Array, planar: bool) -> float:
+	var best := INF
+	for r in runs:
+		var start := Time.get_ticks_usec()
+		var mesh := _planar(arrays) if planar else _surface_tool(arrays)
+		best = min(best, (Time.get_ticks_usec() - start) / 1000.0)
+		mesh = null
+	return best
+
+
+func _measure(n: int) -> void:
+	var arrays := _make_arrays(n)
+	var vertex_count: int = arrays[Mesh.ARRAY_VERTEX].size()
+	var planar := _best_msec(arrays, true)
+	var surface_tool := _best_msec(arrays, false)
+	print("%7d vertices: planar %8.2f ms, SurfaceTool %9.2f ms (%.1fx)" % [
+			vertex_count, planar, surface_tool, surface_tool / planar])
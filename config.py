@@ -12,13 +12,17 @@ def get_doc_path():
 
 def get_doc_classes():
     return [
+        "VGAbstractMeshRenderer",
+        "VGBatch",
         "VGColor",
         "VGGradient",
         "VGLinearGradient",
         "VGMeshRenderer",
+        "VGMorph",
         "VGPaint",
         "VGPath",
         "VGRadialGradient",
         "VGRenderer",
+        "VGRigidMeshRenderer",
         "EditorSceneImporterSVG",
     ]
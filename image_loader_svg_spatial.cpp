@@ -2,6 +2,7 @@
 #ifdef TOOLS_ENABLED
 #include "image_loader_svg_spatial.h"
 
+#include "core/object/worker_thread_pool.h"
 #include "scene/3d/importer_mesh_instance_3d.h"
 #include "scene/resources/3d/importer_mesh.h"
 
@@ -10,17 +11,97 @@ EditorSceneImporterSVG::EditorSceneImporterSVG() {
 
 EditorSceneImporterSVG::~EditorSceneImporterSVG() {
 }
+
+void EditorSceneImporterSVG::TesselateTask::tesselate_job(uint32_t p_job, const tove::TesselatorRef &p_tesselator, const tove::GraphicsRef &p_graphics) {
+	PathJob &job = jobs[p_job];
+	if (!job.tove_path) {
+		return;
+	}
+
+	// the merged surface only carries vertex colors, so gradients are baked
+	// into them rather than dropped with a PaintMesh's material.
+	job.tove_mesh = tove::tove_make_shared<tove::ColorMesh>(tove::VERTEX_LAYOUT_SPLIT);
+
+	int fill_index = 0;
+	int line_index = 0;
+	VGAbstractMeshRenderer::tesselate_path(p_tesselator, p_graphics, job.tove_path, job.scale,
+			job.tove_mesh, fill_index, line_index);
+}
+
+void EditorSceneImporterSVG::TesselateTask::tesselate_jobs(uint32_t p_task, void *p_userdata) {
+	const tove::TesselatorRef &tesselator = tesselators[p_task];
+	const tove::GraphicsRef &task_graphics = graphics[p_task];
+	const uint32_t n = jobs.size();
+	uint32_t job_i = next_job.postincrement();
+	while (job_i < n) {
+		tesselate_job(job_i, tesselator, task_graphics);
+		job_i = next_job.postincrement();
+	}
+}
+
+// writes every path's ColorMesh into one set of surface arrays in a single
+// pass, placing each at its center and depth gap.
+Array EditorSceneImporterSVG::build_batch_arrays(const LocalVector<PathJob> &p_jobs, const LocalVector<Point2> &p_centers) {
+	uint32_t vertex_count = 0;
+	uint32_t index_count = 0;
+	for (const PathJob &job : p_jobs) {
+		if (job.tove_mesh) {
+			vertex_count += job.tove_mesh->getVertexCount();
+			index_count += job.tove_mesh->getIndexCount();
+		}
+	}
+
+	PackedVector3Array vertices;
+	PackedColorArray colors;
+	PackedInt32Array indices;
+	vertices.resize(vertex_count);
+	colors.resize(vertex_count);
+	indices.resize(index_count);
+
+	Vector3 *w_vertices = vertices.ptrw();
+	Color *w_colors = colors.ptrw();
+	int32_t *w_indices = indices.ptrw();
+
+	uint32_t vertex_base = 0;
+	uint32_t index_base = 0;
+
+	for (uint32_t mesh_i = 0; mesh_i < p_jobs.size(); mesh_i++) {
+		const tove::MeshRef &tove_mesh = p_jobs[mesh_i].tove_mesh;
+		if (!tove_mesh) {
+			continue;
+		}
+
+		const Point2 &center = p_centers[mesh_i];
+		const real_t gap = mesh_i * CMP_POINT_IN_PLANE_EPSILON * 16.0f;
+		const Vector3 offset(center.x * 0.001f, center.y * -0.001f, gap);
+		copy_mesh_vertices(tove_mesh, offset, w_vertices + vertex_base, w_colors + vertex_base);
+		copy_mesh_indices(tove_mesh, vertex_base, w_indices + index_base);
+
+		vertex_base += tove_mesh->getVertexCount();
+		index_base += tove_mesh->getIndexCount();
+	}
+
+	Array arrays;
+	arrays.resize(Mesh::ARRAY_MAX);
+	arrays[Mesh::ARRAY_VERTEX] = vertices;
+	arrays[Mesh::ARRAY_COLOR] = colors;
+	arrays[Mesh::ARRAY_INDEX] = indices;
+	add_planar_normals(arrays, vertex_count);
+	return arrays;
+}
+
+void EditorSceneImporterSVG::get_import_options(const String &p_path, List<ResourceImporter::ImportOption> *r_options) {
+	if (!p_path.is_empty() && p_path.get_extension().to_lower() != "svg") {
+		return;
+	}
+	r_options->push_back(ResourceImporter::ImportOption(PropertyInfo(Variant::BOOL, "svg/parallel_tessellation"), true));
+}
+
 Node *EditorSceneImporterSVG::import_scene(const String &p_path, uint32_t p_flags, const HashMap<StringName, Variant> &p_options, List<String> *r_missing_deps, Error *r_err) {
-	String units = "px";
-	float dpi = 96.0;
-	Vector<uint8_t> buf = FileAccess::get_file_as_bytes(p_path);
-	if (!buf.size()) {
+	tove::GraphicsRef tove_graphics = load_svg_graphics(p_path);
+	if (!tove_graphics) {
 		return nullptr;
 	}
-	String str;
-	str.parse_utf8((const char *)buf.ptr(), buf.size());
-	tove::GraphicsRef tove_graphics = tove::Graphics::createFromSVG(
-			str.utf8().ptr(), units.utf8().ptr(), dpi);
 	const float *tove_bounds = tove_graphics->getBounds();
 	float s = 256.0f / MAX(tove_bounds[2] - tove_bounds[0], tove_bounds[3] - tove_bounds[1]);
 	if (s > 1.0f) {
@@ -28,6 +109,10 @@ Node *EditorSceneImporterSVG::import_scene(const String &p_path, uint32_t p_flag
 		transform.setWantsScaleLineWidth(true);
 		tove_graphics->set(tove_graphics, transform);
 	}
+	bool parallel = true;
+	if (p_options.has("svg/parallel_tessellation")) {
+		parallel = p_options["svg/parallel_tessellation"];
+	}
 	int32_t n = tove_graphics->getNumPaths();
 	Ref<VGMeshRenderer> renderer;
 	renderer.instantiate();
@@ -35,8 +120,11 @@ Node *EditorSceneImporterSVG::import_scene(const String &p_path, uint32_t p_flag
 	VGPath *root_path = memnew(VGPath(tove::tove_make_shared<tove::Path>()));
 	root_path->set_renderer(renderer);
 	Node3D *root = memnew(Node3D);
-	Ref<SurfaceTool> st;
-	st.instantiate();
+
+	// scene setup stays on this thread; only tove data reaches the workers.
+	LocalVector<Point2> centers;
+	TesselateTask task;
+	task.jobs.resize(n);
 	for (int mesh_i = 0; mesh_i < n; mesh_i++) {
 		tove::PathRef tove_path = tove_graphics->getPath(mesh_i);
 		Point2 center = compute_center(tove_path);
@@ -45,26 +133,36 @@ Node *EditorSceneImporterSVG::import_scene(const String &p_path, uint32_t p_flag
 		path->set_position(center);
 		root_path->add_child(path, true);
 		path->set_owner(root);
-		Ref<ArrayMesh> mesh;
-		mesh.instantiate();
-		Ref<Texture> texture;
-		Ref<Material> renderer_material;
-		Rect2 area = renderer->render_mesh(mesh, renderer_material, texture, path, true, true);
+		centers.push_back(center);
+
+		Rect2 area = tove_bounds_to_rect2(tove_path->getBounds());
 		if (area.is_equal_approx(Rect2())) {
 			continue;
 		}
-		if (renderer_material.is_valid()) {
-			mesh->surface_set_material(0, renderer_material);
-		}
-		Transform3D xform;
-		real_t gap = mesh_i * CMP_POINT_IN_PLANE_EPSILON * 16.0f;
-		xform.origin = Vector3(center.x * 0.001f, center.y * -0.001f, gap);
-		if (mesh.is_null()) {
-			continue;
-		}
-		st->set_smooth_group(true);
-		st->append_from(mesh, 0, xform);
+		PathJob &job = task.jobs[mesh_i];
+		job.tove_path = new_transformed_path(tove_path, Transform2D());
+		Size2 scale = path->get_transform().get_scale();
+		job.scale = MAX(scale.width, scale.height);
 	}
+	const tove::GraphicsRef root_graphics = root_path->get_subtree_graphics();
+
+	// workers never see root_graphics: whatever a tesselator computes from
+	// the clips happens on a task's own copy.
+	const uint32_t num_tasks = parallel ? MIN(uint32_t(WorkerThreadPool::get_singleton()->get_thread_count()), uint32_t(n)) : 1;
+	for (uint32_t task_i = 0; task_i < num_tasks; task_i++) {
+		task.tesselators.push_back(renderer->new_tesselator());
+		task.graphics.push_back(new_clip_graphics(root_graphics));
+	}
+	if (num_tasks > 1) {
+		WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(
+				&task, &TesselateTask::tesselate_jobs, (void *)nullptr, num_tasks, num_tasks, true, SNAME("SVGTesselate"));
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+	} else if (num_tasks == 1) {
+		task.tesselate_jobs(0, nullptr);
+	}
+
+	Array arrays = build_batch_arrays(task.jobs, centers);
+	task.jobs.clear();
 	String root_name;
 	root_name = String(root_path->get_name()).get_basename();
 	memdelete(root_path);
@@ -76,8 +174,7 @@ Node *EditorSceneImporterSVG::import_scene(const String &p_path, uint32_t p_flag
 	standard_material->set_depth_draw_mode(StandardMaterial3D::DEPTH_DRAW_ALWAYS);
 	standard_material->set_flag(StandardMaterial3D::FLAG_DISABLE_DEPTH_TEST, true);
 	standard_material->set_cull_mode(StandardMaterial3D::CULL_DISABLED);
-	combined_mesh->add_surface(Mesh::PRIMITIVE_TRIANGLES, st->commit_to_arrays(), Array(), Dictionary(), standard_material, "", 0);
-	st->commit();
+	combined_mesh->add_surface(Mesh::PRIMITIVE_TRIANGLES, arrays, Array(), Dictionary(), standard_material, "", 0);
 	if (combined_mesh.is_null()) {
 		return nullptr;
 	}
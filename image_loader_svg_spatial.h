@@ -4,6 +4,8 @@
 
 #ifdef TOOLS_ENABLED
 #include "core/io/file_access.h"
+#include "core/templates/local_vector.h"
+#include "core/templates/safe_refcount.h"
 #include "editor/editor_file_system.h"
 #include "editor/import/3d/resource_importer_scene.h"
 #include "scene/3d/mesh_instance_3d.h"
@@ -22,10 +24,33 @@ class EditorSceneImporterSVG : public EditorSceneFormatImporter {
 		return Point2((bounds[0] + bounds[2]) / 2, (bounds[1] + bounds[3]) / 2);
 	}
 
+	struct PathJob {
+		tove::PathRef tove_path;
+		tove::MeshRef tove_mesh;
+		float scale = 1.0f;
+	};
+
+	// flatten, clip and triangulate run per path on the WorkerThreadPool; each
+	// task owns its tesselator and a copy of the clips, made on the calling
+	// thread, and every job writes only its own mesh, so the merge below sees
+	// the same data no matter how jobs were scheduled.
+	struct TesselateTask {
+		LocalVector<PathJob> jobs;
+		LocalVector<tove::TesselatorRef> tesselators;
+		LocalVector<tove::GraphicsRef> graphics;
+		SafeNumeric<uint32_t> next_job;
+
+		void tesselate_job(uint32_t p_job, const tove::TesselatorRef &p_tesselator, const tove::GraphicsRef &p_graphics);
+		void tesselate_jobs(uint32_t p_task, void *p_userdata);
+	};
+
+	static Array build_batch_arrays(const LocalVector<PathJob> &p_jobs, const LocalVector<Point2> &p_centers);
+
 public:
 	EditorSceneImporterSVG();
 	~EditorSceneImporterSVG();
 	virtual void get_extensions(List<String> *r_extensions) const override;
+	virtual void get_import_options(const String &p_path, List<ResourceImporter::ImportOption> *r_options) override;
  	virtual Node *import_scene(const String &p_path, uint32_t p_flags, const HashMap<StringName, Variant> &p_options, List<String> *r_missing_deps, Error *r_err = nullptr) override;
 };
 #endif
@@ -5,13 +5,16 @@
 #include "register_types.h"
 #include "image_loader_svg_spatial.h"
 #include "vector_graphics_adaptive_renderer.h"
+#include "vector_graphics_batch.h"
 #include "vector_graphics_color.h"
 #include "vector_graphics_gradient.h"
 #include "vector_graphics_linear_gradient.h"
+#include "vector_graphics_morph.h"
 #include "vector_graphics_paint.h"
 #include "vector_graphics_path.h"
 #include "vector_graphics_radial_gradient.h"
 #include "vector_graphics_renderer.h"
+#include "vector_graphics_rigid_renderer.h"
 
 #include "core/object/ref_counted.h"
 
@@ -26,6 +29,7 @@ static void editor_init_callback() {
 
 void initialize_svg_mesh_module(ModuleInitializationLevel p_level) {
 	ClassDB::register_class<VGPath>();
+	ClassDB::register_class<VGBatch>();
 	ClassDB::register_abstract_class<VGPaint>();
 	ClassDB::register_class<VGColor>();
 	ClassDB::register_class<VGGradient>();
@@ -33,7 +37,10 @@ void initialize_svg_mesh_module(ModuleInitializationLevel p_level) {
 	ClassDB::register_class<VGRadialGradient>();
 
 	ClassDB::register_abstract_class<VGRenderer>();
+	ClassDB::register_abstract_class<VGAbstractMeshRenderer>();
 	ClassDB::register_class<VGMeshRenderer>();
+	ClassDB::register_class<VGRigidMeshRenderer>();
+	ClassDB::register_class<VGMorph>();
 #ifdef TOOLS_ENABLED
 	ClassDB::APIType prev_api = ClassDB::get_current_api();
 	ClassDB::set_current_api(ClassDB::API_EDITOR);
@@ -44,4 +51,6 @@ void initialize_svg_mesh_module(ModuleInitializationLevel p_level) {
 }
 
 void uninitialize_svg_mesh_module(ModuleInitializationLevel p_level) {
+	free_gradient_resources();
+	free_svg_parse_contexts();
 }
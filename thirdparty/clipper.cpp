@@ -47,6 +47,8 @@
 #include <cstdlib>
 #include <ostream>
 #include <functional>
+#include <cstddef>
+#include <new>
 
 namespace ClipperLib {
 
@@ -63,7 +65,62 @@ static int const Skip = -2;        //edge that would otherwise close a path
 #define TOLERANCE (1.0e-20)
 #define NEAR_ZERO(val) (((val) > -TOLERANCE) && ((val) < TOLERANCE))
 
-struct TEdge {
+static thread_local ClipperScratch *activeScratch = NULL;
+
+ClipperScratch *ClipperScratch::GetActive()
+{
+  return activeScratch;
+}
+//------------------------------------------------------------------------------
+
+void ClipperScratch::SetActive(ClipperScratch *scratch)
+{
+  activeScratch = scratch;
+}
+//------------------------------------------------------------------------------
+
+//every block starts with a header telling ClipperFree where it came from, so
+//heap blocks freed while a scratch is active (and vice versa) stay correct.
+union ClipperBlockHeader {
+  bool scratch;
+  std::max_align_t align;
+};
+
+void *ClipperAllocate(size_t size)
+{
+  ClipperBlockHeader *header;
+  if (activeScratch)
+  {
+    header = (ClipperBlockHeader*)activeScratch->Allocate(sizeof(ClipperBlockHeader) + size);
+    header->scratch = true;
+  } else
+  {
+    header = (ClipperBlockHeader*)std::malloc(sizeof(ClipperBlockHeader) + size);
+    if (!header) throw std::bad_alloc();
+    header->scratch = false;
+  }
+  return header + 1;
+}
+//------------------------------------------------------------------------------
+
+void ClipperFree(void *p)
+{
+  if (!p) return;
+  ClipperBlockHeader *header = ((ClipperBlockHeader*)p) - 1;
+  if (!header->scratch) std::free(header);
+}
+//------------------------------------------------------------------------------
+
+//the internal records below are new'd and deleted one by one; this routes
+//them through ClipperAllocate.
+struct ScratchObject {
+  static void *operator new(size_t size) {return ClipperAllocate(size);}
+  static void *operator new[](size_t size) {return ClipperAllocate(size);}
+  static void operator delete(void *p) {ClipperFree(p);}
+  static void operator delete[](void *p) {ClipperFree(p);}
+};
+
+struct TEdge : ScratchObject {
   IntPoint Bot;
   IntPoint Curr; //current (updated for every new scanbeam)
   IntPoint Top;
@@ -83,7 +140,7 @@ struct TEdge {
   TEdge *PrevInSEL;
 };
 
-struct IntersectNode {
+struct IntersectNode : ScratchObject {
   TEdge          *Edge1;
   TEdge          *Edge2;
   IntPoint        Pt;
@@ -99,7 +156,7 @@ struct OutPt;
 
 //OutRec: contains a path in the clipping solution. Edges in the AEL will
 //carry a pointer to an OutRec when they are part of the clipping solution.
-struct OutRec {
+struct OutRec : ScratchObject {
   int       Idx;
   bool      IsHole;
   bool      IsOpen;
@@ -109,14 +166,14 @@ struct OutRec {
   OutPt    *BottomPt;
 };
 
-struct OutPt {
+struct OutPt : ScratchObject {
   int       Idx;
   IntPoint  Pt;
   OutPt    *Next;
   OutPt    *Prev;
 };
 
-struct Join {
+struct Join : ScratchObject {
   OutPt    *OutPt1;
   OutPt    *OutPt2;
   IntPoint  OffPt;
@@ -207,10 +207,43 @@ struct OutPt;
 struct OutRec;
 struct Join;
 
-typedef std::vector < OutRec* > PolyOutList;
-typedef std::vector < TEdge* > EdgeList;
-typedef std::vector < Join* > JoinList;
-typedef std::vector < IntersectNode* > IntersectList;
+//Scratch memory hook (tove). While a ClipperScratch is active on the calling
+//thread, a Clipper's edges, output points, records, joins and work lists are
+//carved from it and individual frees become no-ops; the scratch's owner
+//releases everything at once. A Clipper or ClipperOffset used while a scratch
+//is active must not outlive it. Results (Paths, PolyTree) stay on the heap.
+class ClipperScratch
+{
+public:
+  virtual ~ClipperScratch() {}
+  //returns at least size bytes, aligned like max_align_t
+  virtual void *Allocate(size_t size) = 0;
+  static ClipperScratch *GetActive();
+  static void SetActive(ClipperScratch *scratch);
+};
+
+void *ClipperAllocate(size_t size);
+void ClipperFree(void *p);
+
+template<typename T>
+struct ClipperScratchAllocator
+{
+  typedef T value_type;
+  ClipperScratchAllocator() {}
+  template<typename U>
+  ClipperScratchAllocator(const ClipperScratchAllocator<U> &) {}
+  T *allocate(size_t n) {return static_cast<T*>(ClipperAllocate(n * sizeof(T)));}
+  void deallocate(T *p, size_t) {ClipperFree(p);}
+  template<typename U>
+  bool operator==(const ClipperScratchAllocator<U> &) const {return true;}
+  template<typename U>
+  bool operator!=(const ClipperScratchAllocator<U> &) const {return false;}
+};
+
+typedef std::vector < OutRec*, ClipperScratchAllocator<OutRec*> > PolyOutList;
+typedef std::vector < TEdge*, ClipperScratchAllocator<TEdge*> > EdgeList;
+typedef std::vector < Join*, ClipperScratchAllocator<Join*> > JoinList;
+typedef std::vector < IntersectNode*, ClipperScratchAllocator<IntersectNode*> > IntersectList;
 
 //------------------------------------------------------------------------------
 
@@ -244,7 +277,7 @@ protected:
   void DeleteFromAEL(TEdge *e);
   void UpdateEdgeIntoAEL(TEdge *&e);
 
-  typedef std::vector<LocalMinimum> MinimaList;
+  typedef std::vector<LocalMinimum, ClipperScratchAllocator<LocalMinimum> > MinimaList;
   MinimaList::iterator m_CurrentLM;
   MinimaList           m_MinimaList;
 
@@ -255,7 +288,7 @@ protected:
   PolyOutList       m_PolyOuts;
   TEdge           *m_ActiveEdges;
 
-  typedef std::priority_queue<cInt> ScanbeamList;
+  typedef std::priority_queue<cInt, std::vector<cInt, ClipperScratchAllocator<cInt> > > ScanbeamList;
   ScanbeamList     m_Scanbeam;
 };
 //------------------------------------------------------------------------------
@@ -293,7 +326,7 @@ private:
   JoinList         m_GhostJoins;
   IntersectList    m_IntersectList;
   ClipType         m_ClipType;
-  typedef std::list<cInt> MaximaList;
+  typedef std::list<cInt, ClipperScratchAllocator<cInt> > MaximaList;
   MaximaList       m_Maxima;
   TEdge           *m_SortedEdges;
   bool             m_ExecuteLocked;
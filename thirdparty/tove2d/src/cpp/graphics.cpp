@@ -28,11 +28,12 @@
 BEGIN_TOVE_NAMESPACE
 
 GraphicsRef Graphics::createFromSVG(
-	const char *svg, const char *units, float dpi) {
+	const char *svg, const char *units, float dpi,
+	nsvg::ParseContext *context) {
 
 	GraphicsRef graphics;
 	if (svg) {
-		NSVGimage *image = nsvg::parseSVG(svg, units, dpi);
+		NSVGimage *image = nsvg::parseSVG(svg, units, dpi, context);
 
 		graphics = tove_make_shared<Graphics>(image);
 		nsvgDelete(image);
@@ -114,11 +115,6 @@ Clip::Clip(const ClipRef &source, const nsvg::Transform &transform) {
 	}
 }
 
-void Clip::compute(const AbstractTesselator &tess) {
-    computed = tess.toClipPath(paths);
-}
-
-
 void ClipSet::link() {
 	for (int i = 1; i < clips.size(); i++) {
 		clips[i - 1]->setNext(clips[i]);
@@ -477,16 +473,6 @@ void Graphics::animate(const GraphicsRef &a, const GraphicsRef &b, float t) {
 	}
 }
 
-void Graphics::computeClipPaths(const AbstractTesselator &tess) const {
-#ifdef NSVG_CLIP_PATHS
-	if (clipSet) {
-		for (const ClipRef &clip : clipSet->getClips()) {
-			clip->compute(tess);
-		}
-	}
-#endif
-}
-
 void Graphics::clearChanges(ToveChangeFlags flags) {
 	flags &= ~(CHANGED_BOUNDS | CHANGED_EXACT_BOUNDS);
 	changes &= ~flags;
@@ -31,11 +31,8 @@ public:
 		nsvg.next = &clip->nsvg;
 	}
 
-	void compute(const AbstractTesselator &tess);
-
 	TOVEclipPath nsvg;
 	std::vector<PathRef> paths;
-	ClipperLib::Paths computed;
 };
 
 class ClipSet : public Referencable { // clip sets are immutable.
@@ -130,7 +127,8 @@ public:
 	NSVGimage nsvg;
 
 	static GraphicsRef createFromSVG(
-		const char *svg, const char *units, float dpi);
+		const char *svg, const char *units, float dpi,
+		nsvg::ParseContext *context = nullptr);
 
 	Graphics();
 	Graphics(const ClipSetRef &clipSet);
@@ -227,8 +225,6 @@ public:
 
 	void animate(const GraphicsRef &a, const GraphicsRef &b, float t);
 
-	void computeClipPaths(const AbstractTesselator &tess) const;
-
 #ifdef NSVG_CLIP_PATHS
 	inline const ClipSetRef &getClipSet() const {
 		return clipSet;
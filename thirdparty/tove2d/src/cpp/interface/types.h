@@ -69,6 +69,11 @@ typedef enum {
 	TOVE_HOLES_CCW
 } ToveHoles;
 
+typedef enum {
+	TOVE_TRIANGULATION_EAR_CLIPPING,
+	TOVE_TRIANGULATION_MONOTONE
+} ToveTriangulation;
+
 typedef enum {
 	TOVE_HANDLE_FREE,
 	TOVE_HANDLE_ALIGNED
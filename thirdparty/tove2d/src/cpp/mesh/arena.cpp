@@ -0,0 +1,82 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "arena.h"
+#include <cstddef>
+#include <cstdlib>
+#include <algorithm>
+
+BEGIN_TOVE_NAMESPACE
+
+static constexpr size_t arenaAlignment = alignof(std::max_align_t);
+
+ScratchArena::ScratchArena(size_t retainLimit) :
+	used(0), retainLimit(retainLimit) {
+}
+
+ScratchArena::~ScratchArena() {
+	releaseBlocks();
+}
+
+void ScratchArena::addBlock(size_t size) {
+	uint8_t *data = static_cast<uint8_t*>(malloc(size));
+	if (!data) {
+		TOVE_BAD_ALLOC();
+	}
+	blocks.push_back(Block{data, size});
+	used = 0;
+}
+
+void ScratchArena::releaseBlocks() {
+	for (const Block &block : blocks) {
+		free(block.data);
+	}
+	blocks.clear();
+	used = 0;
+}
+
+void *ScratchArena::Allocate(size_t size) {
+	size = (size + arenaAlignment - 1) & ~(arenaAlignment - 1);
+
+	if (blocks.empty() || used + size > blocks.back().size) {
+		const size_t grow = blocks.empty() ?
+			initialBlockSize : blocks.back().size * 2;
+		addBlock(std::max(size, grow));
+	}
+
+	void *p = blocks.back().data + used;
+	used += size;
+	return p;
+}
+
+void ScratchArena::reset() {
+	const size_t total = getRetainedBytes();
+
+	if (total > retainLimit) {
+		releaseBlocks();
+	} else if (blocks.size() > 1) {
+		// one block big enough for the last pass.
+		releaseBlocks();
+		addBlock(total);
+	}
+
+	used = 0;
+}
+
+size_t ScratchArena::getRetainedBytes() const {
+	size_t total = 0;
+	for (const Block &block : blocks) {
+		total += block.size;
+	}
+	return total;
+}
+
+END_TOVE_NAMESPACE
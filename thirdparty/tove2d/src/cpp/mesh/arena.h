@@ -0,0 +1,90 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_MESH_ARENA
+#define __TOVE_MESH_ARENA 1
+
+#include "../common.h"
+#include <vector>
+
+BEGIN_TOVE_NAMESPACE
+
+// monotonic scratch memory for clipping and triangulation. ClipperLib's
+// internal records, polygons and triangle lists built while a Scope is open
+// are carved from here and released in one go when the scope closes. after a reset, the blocks are merged into one so
+// that steady-state tessellation does not touch the heap; once more than
+// retainLimit bytes were needed, everything is released again.
+class ScratchArena : public TPPLScratch, public ClipperLib::ClipperScratch {
+	struct Block {
+		uint8_t *data;
+		size_t size;
+	};
+
+	std::vector<Block> blocks;
+	size_t used;
+	size_t retainLimit;
+
+	void addBlock(size_t size);
+	void releaseBlocks();
+
+public:
+	static constexpr size_t initialBlockSize = 64 * 1024;
+	static constexpr size_t defaultRetainLimit = 1024 * 1024;
+
+	ScratchArena(size_t retainLimit = defaultRetainLimit);
+	virtual ~ScratchArena();
+
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena &operator=(const ScratchArena&) = delete;
+
+	virtual void *Allocate(size_t size);
+
+	void reset();
+
+	size_t getRetainedBytes() const;
+
+	inline size_t getRetainLimit() const {
+		return retainLimit;
+	}
+	inline void setRetainLimit(size_t limit) {
+		retainLimit = limit;
+	}
+
+	// makes the arena the calling thread's scratch for its lifetime.
+	class Scope {
+		ScratchArena &arena;
+		TPPLScratch * const previous;
+		ClipperLib::ClipperScratch * const previousClipper;
+
+	public:
+		inline Scope(ScratchArena &arena) :
+			arena(arena), previous(TPPLScratch::GetActive()),
+			previousClipper(ClipperLib::ClipperScratch::GetActive()) {
+			TPPLScratch::SetActive(&arena);
+			ClipperLib::ClipperScratch::SetActive(&arena);
+		}
+
+		inline ~Scope() {
+			TPPLScratch::SetActive(previous);
+			ClipperLib::ClipperScratch::SetActive(previousClipper);
+			if (previous != &arena) {
+				arena.reset();
+			}
+		}
+
+		Scope(const Scope&) = delete;
+		Scope &operator=(const Scope&) = delete;
+	};
+};
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_MESH_ARENA
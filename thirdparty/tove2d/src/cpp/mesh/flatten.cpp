@@ -84,20 +84,98 @@ void DefaultCurveFlattener::flatten(
 	flatten(x1234, y1234, x234, y234, x34, y34, x4, y4, points, level + 1);
 }
 
-void AntiGrainFlattener::initialize(
-	const ToveTesselationSettings &quality) {
+ClipperParameters WangCurveFlattener::configure(float scale) {
+	// same clipper setup as DefaultCurveFlattener, so the two can be
+	// swapped without changing anything downstream. its flatness test
+	// stops at about a quarter of the tolerance, so aim for that too.
+	const ClipperParameters parameters =
+		DefaultCurveFlattener(resolution, 0).configure(scale);
+	tolerance = parameters.arcTolerance * 0.25f;
+	return parameters;
+}
+
+void WangCurveFlattener::flatten(
+	float x1, float y1, float x2, float y2,
+	float x3, float y3, float x4, float y4,
+	ClipperPath &points, int /*level*/) const {
+
+	// Wang's formula: n = sqrt(3 * 2 / 8 * M / tolerance), with M the
+	// largest second difference of the control polygon.
+	const double ddx1 = x1 - 2.0 * x2 + x3;
+	const double ddy1 = y1 - 2.0 * y2 + y3;
+	const double ddx2 = x2 - 2.0 * x3 + x4;
+	const double ddy2 = y2 - 2.0 * y3 + y4;
+	const double m = std::sqrt(std::max(
+		ddx1 * ddx1 + ddy1 * ddy1, ddx2 * ddx2 + ddy2 * ddy2));
+
+	int n = 1;
+	if (tolerance > 0.0f) {
+		n = (int)std::ceil(std::sqrt(0.75 * m / tolerance));
+	}
+	n = std::max(1, std::min(n, maxSegments));
+
+	const size_t i0 = points.size();
+	points.resize(i0 + n);
+	ClipperPoint *out = points.data() + i0;
+
+	if (n > 1) {
+		// power basis p(t) = a t^3 + b t^2 + c t + p0, stepped by h.
+		const double ax = x4 - x1 + 3.0 * (x2 - x3);
+		const double ay = y4 - y1 + 3.0 * (y2 - y3);
+		const double bx = 3.0 * (x1 - 2.0 * x2 + x3);
+		const double by = 3.0 * (y1 - 2.0 * y2 + y3);
+		const double cx = 3.0 * (x2 - x1);
+		const double cy = 3.0 * (y2 - y1);
+
+		const double h = 1.0 / n;
+		const double h2 = h * h;
+		const double h3 = h2 * h;
+
+		double px = x1, py = y1;
+		double d1x = ax * h3 + bx * h2 + cx * h;
+		double d1y = ay * h3 + by * h2 + cy * h;
+		double d2x = 6.0 * ax * h3 + 2.0 * bx * h2;
+		double d2y = 6.0 * ay * h3 + 2.0 * by * h2;
+		const double d3x = 6.0 * ax * h3;
+		const double d3y = 6.0 * ay * h3;
+
+		for (int i = 0; i < n - 1; i++) {
+			px += d1x;
+			py += d1y;
+			d1x += d2x;
+			d1y += d2y;
+			d2x += d3x;
+			d2y += d3y;
+			*out++ = ClipperPoint(px, py);
+		}
+	}
 
-	assert(quality.stopCriterion == TOVE_ANTIGRAIN);
+	// land exactly on the end point.
+	*out = ClipperPoint(x4, y4);
+}
 
-	distanceTolerance = quality.antigrain.distanceTolerance;
-	colinearityEpsilon = quality.antigrain.colinearityEpsilon;
-	angleEpsilon = quality.antigrain.angleEpsilon;
-	angleTolerance = quality.antigrain.angleTolerance;
-	cuspLimit = quality.antigrain.cuspLimit;
-	recursionLimit = std::min(
-		toveMaxFlattenSubdivisions, quality.recursionLimit);
+AntiGrainFlattener::AntiGrainFlattener(
+	const AntiGrainSettings &settings,
+	int recursionLimit) :
+
+	colinearityEpsilon(settings.colinearityEpsilon),
+	distanceTolerance(settings.distanceTolerance),
+	angleEpsilon(settings.angleEpsilon),
+	angleTolerance(settings.angleTolerance),
+	cuspLimit(settings.cuspLimit),
+	recursionLimit(std::min(toveMaxFlattenSubdivisions, recursionLimit)),
+	distanceToleranceSquare(0.0f) {
+}
 
-	distanceToleranceSquare = distanceTolerance * distanceTolerance;
+ClipperParameters AntiGrainFlattener::configure(float scale) {
+	// a resolution of 1 / tolerance points per pixel gives the same
+	// clipper setup as DefaultCurveFlattener, with the tolerance in
+	// clipper units as arc tolerance.
+	const ClipperParameters parameters =
+		DefaultCurveFlattener(1.0f / distanceTolerance, 0).configure(scale);
+	distanceToleranceSquare =
+		parameters.arcTolerance * parameters.arcTolerance;
+	return parameters;
 }
 
 void AntiGrainFlattener::flatten(
@@ -372,16 +450,56 @@ inline ClipperLib::EndType endType(int t, bool closed) {
 	}
 }
 
+void AbstractAdaptiveFlattener::flattenSubpaths(
+	const PathRef &path,
+	ClipperPaths &paths) const {
+
+	const int n = path->getNumSubpaths();
+	const int offset = paths.size();
+
+	std::vector<SubpathRef> subpaths;
+	int numPoints = 0;
+	if (executor && n >= minParallelSubpaths) {
+		subpaths.reserve(n);
+		for (int i = 0; i < n; i++) {
+			subpaths.push_back(path->getSubpath(i));
+			numPoints += subpaths.back()->nsvg.npts;
+		}
+	}
+
+	if (numPoints < minParallelPoints) {
+		for (int i = 0; i < n; i++) {
+			paths.push_back(flatten(path->getSubpath(i)));
+		}
+		return;
+	}
+
+	// every subpath gets its own preallocated slot, so jobs never touch
+	// shared state and the output order stays the same.
+	paths.resize(offset + n);
+
+	struct Jobs {
+		const AbstractAdaptiveFlattener *flattener;
+		const SubpathRef *subpaths;
+		ClipperPath *out;
+	} jobs = {this, subpaths.data(), paths.data() + offset};
+
+	executor->run(n, [] (void *userdata, int index) {
+		const Jobs *jobs = static_cast<const Jobs*>(userdata);
+		jobs->out[index] = jobs->flattener->flatten(jobs->subpaths[index]);
+	}, &jobs);
+}
+
 void AbstractAdaptiveFlattener::flatten(
 	const PathRef &path,
 	Tesselation &tesselation) const {
 
+	flattenSubpaths(path, tesselation.fill);
+
 	const int n = path->getNumSubpaths();
 	bool closed = true;
 	for (int i = 0; i < n; i++) {
-		const auto subpath = path->getSubpath(i);
-		tesselation.fill.push_back(flatten(subpath));
-		closed = closed && subpath->isClosed();
+		closed = closed && path->getSubpath(i)->isClosed();
 	}
 
 	NSVGshape * const shape = &path->nsvg;
@@ -25,6 +25,11 @@ struct Tesselation {
 	ClipperLib::PolyTree stroke;
 };
 
+struct ClipperParameters {
+	float scale;
+	float arcTolerance;
+};
+
 class AntiGrainFlattener {
 private:
 	float colinearityEpsilon;
@@ -34,25 +39,22 @@ private:
 	float cuspLimit;
 	int recursionLimit;
 	float distanceToleranceSquare;
-	float clipperScale;
 
 public:
-	void initialize(
-		const ToveTesselationSettings &quality);
+	// the distance tolerance is in pixels, angles are in radians. an angle
+	// tolerance or cusp limit of zero disables that check.
+	AntiGrainFlattener(
+		const AntiGrainSettings &settings,
+		int recursionLimit);
 
-	float configure(float extent);
+	ClipperParameters configure(float extent);
 
-	inline void flatten(
+	void flatten(
 		float x1, float y1, float x2, float y2,
 		float x3, float y3, float x4, float y4,
 		ClipperPath &points, int level) const;
 };
 
-struct ClipperParameters {
-	float scale;
-	float arcTolerance;
-};
-
 class DefaultCurveFlattener {
 private:
 	const float resolution;
@@ -82,8 +84,57 @@ public:
 		ClipperPath &points, int level) const;
 };
 
+// picks each cubic's segment count upfront with Wang's formula, then walks
+// the curve by forward differencing; no recursion, one resize per curve.
+// the bound holds for the whole curve, so unlike recursive subdivision it
+// cannot refine just the sharp end of an uneven cubic.
+class WangCurveFlattener {
+private:
+	const float resolution;
+	const int maxSegments;
+	float tolerance;
+
+public:
+	inline WangCurveFlattener(const WangCurveFlattener& r) :
+		resolution(r.resolution),
+		maxSegments(r.maxSegments),
+		tolerance(0.0f) {
+	}
+
+	// recursionLimit caps segments at what recursive subdivision down to
+	// that level could produce.
+	WangCurveFlattener(
+		float p_resolution,
+		int p_recursionLimit) :
+		resolution(p_resolution),
+		maxSegments(2 << std::min(toveMaxFlattenSubdivisions, p_recursionLimit)),
+		tolerance(0.0f) {
+	}
+
+	ClipperParameters configure(float extent);
+
+	void flatten(
+		float x1, float y1, float x2, float y2,
+		float x3, float y3, float x4, float y4,
+		ClipperPath &points, int level) const;
+};
+
+// runs count independent jobs, possibly at the same time, and returns once
+// all of them are done. embedders plug their thread pool in through this.
+class ParallelExecutor {
+public:
+	typedef void (*Job)(void *userdata, int index);
+
+	virtual void run(int count, Job job, void *userdata) = 0;
+
+	virtual ~ParallelExecutor() {
+	}
+};
+
 class AbstractAdaptiveFlattener {
 private:
+	ParallelExecutor *executor;
+
 	void flatten(
 		float x1, float y1, float x2, float y2,
 		float x3, float y3, float x4, float y4,
@@ -91,6 +142,10 @@ private:
 
 	virtual ClipperPath flatten(const SubpathRef &subpath) const = 0;
 
+	void flattenSubpaths(
+		const PathRef &path,
+		ClipperPaths &paths) const;
+
 	ClipperPaths computeDashes(
 		const NSVGshape *shape, const ClipperPaths &lines) const;
 
@@ -98,12 +153,25 @@ protected:
 	ClipperParameters clipper;
 
 public:
+	// paths with fewer subpaths or points are flattened on the calling
+	// thread; below this, handing out jobs costs more than it saves.
+	static constexpr int minParallelSubpaths = 8;
+	static constexpr int minParallelPoints = 1024;
+
+	inline AbstractAdaptiveFlattener() : executor(nullptr) {
+	}
+
 	virtual void configure(float extent) = 0;
 
 	inline float getClipperScale() const {
 		return clipper.scale;
 	}
 
+	// the executor is not owned and must outlive the flattener.
+	inline void setExecutor(ParallelExecutor *p_executor) {
+		executor = p_executor;
+	}
+
 	void flatten(
 		const PathRef &path,
 		Tesselation &tesselation) const;
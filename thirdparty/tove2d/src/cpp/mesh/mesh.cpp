@@ -12,13 +12,14 @@
 #include "mesh.h"
 #include "../common.h"
 #include "../path.h"
+#include <algorithm>
 #if TOVE_DEBUG
 #include <iostream>
 #endif
 
 BEGIN_TOVE_NAMESPACE
 
-inline void triangulationFailed(const std::list<ToveTPPLPoly> &polys) {
+inline void triangulationFailed(const TPPLPolyList &polys) {
 	tove::report::warn("triangulation failed.");
 }
 
@@ -43,19 +44,29 @@ static void applyHoles(ToveHoles mode, ToveTPPLPoly &poly) {
 	}
 }
 
-AbstractMesh::AbstractMesh(uint16_t stride) :
-		mStride(stride) {
+AbstractMesh::AbstractMesh(uint16_t stride, VertexLayout layout) :
+		mStride(stride),
+		mLayout(layout) {
 	mVertices = nullptr;
+	mAttributes = nullptr;
 	mVertexCount = 0;
+	mCapacity = 0;
+	mAllocations = 0;
 }
 
 AbstractMesh::~AbstractMesh() {
 	if (mVertices) {
 		free(mVertices);
 	}
+	if (mAttributes) {
+		free(mAttributes);
+	}
 	for (auto i : mSubmeshes) {
 		delete i.second;
 	}
+	for (Submesh *submesh : mSpareSubmeshes) {
+		delete submesh;
+	}
 }
 
 ToveTrianglesMode AbstractMesh::getIndexMode() const {
@@ -97,13 +108,72 @@ void AbstractMesh::copyIndexData(
 	}
 }
 
+void AbstractMesh::copyIndexData(
+		int32_t *indices,
+		int32_t indexCount,
+		int32_t base) const {
+
+	int32_t offset = 0;
+	for (auto submesh : mSubmeshes) {
+		Submesh *m = submesh.second;
+		m->copyIndexData(
+				indices + offset, indexCount - offset, base);
+		offset += m->getIndexCount();
+	}
+}
+
+void AbstractMesh::resize(int32_t capacity) {
+	mCapacity = capacity;
+	mAllocations++;
+
+	if (mLayout == VERTEX_LAYOUT_SPLIT) {
+		mVertices = realloc(
+				mVertices,
+				capacity * sizeof(vec2));
+		if (getAttributeSize() > 0) {
+			mAttributes = static_cast<uint8_t*>(realloc(
+					mAttributes,
+					capacity * getAttributeSize()));
+		}
+	} else {
+		mVertices = realloc(
+				mVertices,
+				capacity * mStride);
+	}
+
+	if (capacity > 0 && !mVertices) {
+		TOVE_BAD_ALLOC();
+	}
+}
+
 void AbstractMesh::reserve(int32_t n) {
 	if (n > mVertexCount) {
 		mVertexCount = n;
 
-		mVertices = realloc(
-				mVertices,
-				nextpow2(mVertexCount) * mStride);
+		if (n > mCapacity) {
+			resize(nextpow2(n));
+		}
+	}
+}
+
+void AbstractMesh::copyVertexData(void *buffer, size_t bufferByteSize) {
+	const size_t size = mStride * mVertexCount;
+	assert(bufferByteSize == size);
+
+	if (mLayout == VERTEX_LAYOUT_SPLIT) {
+		// callers always get the interleaved layout.
+		const uint16_t attributeSize = getAttributeSize();
+		uint8_t *out = static_cast<uint8_t*>(buffer);
+		const vec2 *positions = getPositionData();
+		const uint8_t *attributes = mAttributes;
+		for (int32_t i = 0; i < mVertexCount; i++) {
+			std::memcpy(out, positions++, sizeof(vec2));
+			std::memcpy(out + sizeof(vec2), attributes, attributeSize);
+			attributes += attributeSize;
+			out += mStride;
+		}
+	} else {
+		std::memcpy(buffer, mVertices, size);
 	}
 }
 
@@ -115,12 +185,59 @@ void AbstractMesh::cache(bool keyframe) {
 
 void AbstractMesh::clear() {
 	mVertexCount = 0;
+	mPaintRanges.clear();
 	for (auto submesh : mSubmeshes) {
+		mAllocations += submesh.second->getAllocationCount();
 		delete submesh.second;
 	}
 	mSubmeshes.clear();
 }
 
+void AbstractMesh::recycle() {
+	mVertexCount = 0;
+	mPaintRanges.clear();
+	for (auto submesh : mSubmeshes) {
+		submesh.second->clearTriangles();
+		mSpareSubmeshes.push_back(submesh.second);
+	}
+	mSubmeshes.clear();
+}
+
+void AbstractMesh::shrinkToFit() {
+	for (Submesh *submesh : mSpareSubmeshes) {
+		mAllocations += submesh->getAllocationCount();
+		delete submesh;
+	}
+	mSpareSubmeshes.clear();
+
+	for (auto submesh : mSubmeshes) {
+		submesh.second->shrinkToFit();
+	}
+
+	if (mCapacity > mVertexCount) {
+		if (mVertexCount == 0) {
+			free(mVertices);
+			mVertices = nullptr;
+			free(mAttributes);
+			mAttributes = nullptr;
+			mCapacity = 0;
+		} else {
+			resize(mVertexCount);
+		}
+	}
+}
+
+uint64_t AbstractMesh::getAllocationCount() const {
+	uint64_t count = mAllocations;
+	for (auto submesh : mSubmeshes) {
+		count += submesh.second->getAllocationCount();
+	}
+	for (const Submesh *submesh : mSpareSubmeshes) {
+		count += submesh->getAllocationCount();
+	}
+	return count;
+}
+
 void AbstractMesh::clearTriangles() {
 	for (auto submesh : mSubmeshes) {
 		submesh.second->clearTriangles();
@@ -134,9 +251,10 @@ void Submesh::cache(bool keyframe) {
 void Submesh::addClipperPaths(
 		const ClipperPaths &paths,
 		float scale,
-		ToveHoles holes) {
+		ToveHoles holes,
+		ToveTriangulation triangulation) {
 
-	std::list<ToveTPPLPoly> polys;
+	TPPLPolyList polys;
 	for (const ClipperPath &path : paths) {
 		const int n = path.size();
 		ToveTPPLPoly poly;
@@ -164,7 +282,19 @@ void Submesh::addClipperPaths(
 	}
 
 	ToveTPPLPartition partition;
-	std::list<ToveTPPLPoly> triangles;
+	TPPLPolyList triangles;
+
+	if (triangulation == TOVE_TRIANGULATION_MONOTONE) {
+		// monotone partition handles holes in its sweep and runs in
+		// O(n log n); it rejects some degenerate inputs (e.g. repeated
+		// points) that ear clipping copes with, so fall back on failure.
+		if (partition.Triangulate_MONO(&polys, &triangles) != 0) {
+			mTriangles.add(triangles);
+			return;
+		}
+		triangles.clear();
+	}
+
 	if (partition.Triangulate_EC(&polys, &triangles) == 0) {
 		triangulationFailed(polys);
 		return;
@@ -335,7 +465,7 @@ void Submesh::triangulateFixedResolutionFill(
 
 	const int numSubpaths = path->getNumSubpaths();
 
-	std::list<ToveTPPLPoly> polys;
+	TPPLPolyList polys;
 	int vertexIndex = vertexIndex0;
 
 	for (int i = 0; i < numSubpaths; i++) {
@@ -388,7 +518,7 @@ void Submesh::triangulateFixedResolutionFill(
 
 	ToveTPPLPartition partition;
 
-	std::list<ToveTPPLPoly> convex;
+	TPPLPolyList convex;
 	if (partition.ConvexPartition_HM(&polys, &convex) == 0) {
 		tove::report::warn("triangulation (ConvexPartition_HM) failed.");
 		return;
@@ -396,7 +526,7 @@ void Submesh::triangulateFixedResolutionFill(
 
 	Triangulation *triangulation = new Triangulation(convex);
 	for (auto i = convex.begin(); i != convex.end(); i++) {
-		std::list<ToveTPPLPoly> triangles;
+		TPPLPolyList triangles;
 		ToveTPPLPoly &p = *i;
 
 		//if (partition.Triangulate_MONO(&p, &triangles) == 0) {
@@ -426,18 +556,24 @@ Submesh *AbstractMesh::submesh(const PathRef &path, int line) {
 	if (i != mSubmeshes.end()) {
 		return i->second;
 	} else {
-		Submesh *submesh = new Submesh(this);
+		Submesh *submesh;
+		if (!mSpareSubmeshes.empty()) {
+			submesh = mSpareSubmeshes.back();
+			mSpareSubmeshes.pop_back();
+		} else {
+			submesh = new Submesh(this);
+		}
 		mSubmeshes[id] = submesh;
 		return submesh;
 	}
 }
 
-Mesh::Mesh() :
-		AbstractMesh(sizeof(float) * 2) {
+Mesh::Mesh(VertexLayout layout) :
+		AbstractMesh(sizeof(float) * 2, layout) {
 }
 
-ColorMesh::ColorMesh() :
-		AbstractMesh(sizeof(float) * 2 + 4) {
+ColorMesh::ColorMesh(VertexLayout layout) :
+		AbstractMesh(sizeof(float) * 2 + 4, layout) {
 }
 
 void ColorMesh::setLineColor(
@@ -446,6 +582,7 @@ void ColorMesh::setLineColor(
 	NSVGshape *shape = path->getNSVG();
 	paint.initialize(shape->stroke, shape->opacity, 1.0f);
 	setColor(vertexIndex, vertexCount, paint);
+	mPaintRanges.push_back(PaintRange{vertexIndex, vertexCount, true});
 }
 
 void ColorMesh::setFillColor(
@@ -454,6 +591,7 @@ void ColorMesh::setFillColor(
 	NSVGshape *shape = path->getNSVG();
 	paint.initialize(shape->fill, shape->opacity, 1.0f);
 	setColor(vertexIndex, vertexCount, paint);
+	mPaintRanges.push_back(PaintRange{vertexIndex, vertexCount, false});
 }
 
 void ColorMesh::setColor(
@@ -461,37 +599,13 @@ void ColorMesh::setColor(
 
 	switch (paint.getType()) {
 		case NSVG_PAINT_LINEAR_GRADIENT: {
-			auto vertex = vertices(vertexIndex, vertexCount);
-			for (int i = 0; i < vertexCount; i++) {
-				const float x = vertex->x;
-				const float y = vertex->y;
-
-				const int color = paint.getLinearGradientColor(x, y);
-				uint8_t *colors = vertex.attr();
-				*colors++ = (color >> 0) & 0xff;
-				*colors++ = (color >> 8) & 0xff;
-				*colors++ = (color >> 16) & 0xff;
-				*colors++ = (color >> 24) & 0xff;
-
-				vertex++;
-			}
+			paint.getLinearGradientColors(
+				vertices(vertexIndex, vertexCount), vertexCount);
 		} break;
 
 		case NSVG_PAINT_RADIAL_GRADIENT: {
-			auto vertex = vertices(vertexIndex, vertexCount);
-			for (int i = 0; i < vertexCount; i++) {
-				const float x = vertex->x;
-				const float y = vertex->y;
-
-				const int color = paint.getRadialGradientColor(x, y);
-				uint8_t *colors = vertex.attr();
-				*colors++ = (color >> 0) & 0xff;
-				*colors++ = (color >> 8) & 0xff;
-				*colors++ = (color >> 16) & 0xff;
-				*colors++ = (color >> 24) & 0xff;
-
-				vertex++;
-			}
+			paint.getRadialGradientColors(
+				vertices(vertexIndex, vertexCount), vertexCount);
 		} break;
 
 		default: {
@@ -503,6 +617,14 @@ void ColorMesh::setColor(
 			const int a = (color >> 24) & 0xff;
 
 			auto vertex = vertices(vertexIndex, vertexCount);
+			if (mLayout == VERTEX_LAYOUT_SPLIT) {
+				const uint8_t rgba[4] = {uint8_t(r), uint8_t(g), uint8_t(b), uint8_t(a)};
+				uint32_t packed;
+				std::memcpy(&packed, rgba, 4);
+				std::fill_n(reinterpret_cast<uint32_t*>(vertex.attr()), vertexCount, packed);
+				break;
+			}
+
 			for (int i = 0; i < vertexCount; i++) {
 				uint8_t *colors = vertex.attr();
 				*colors++ = r;
@@ -516,8 +638,8 @@ void ColorMesh::setColor(
 	}
 }
 
-PaintMesh::PaintMesh() :
-		AbstractMesh(sizeof(float) * 3) {
+PaintMesh::PaintMesh(VertexLayout layout) :
+		AbstractMesh(sizeof(float) * 3, layout) {
 }
 
 void PaintMesh::setLineColor(
@@ -538,6 +660,11 @@ void PaintMesh::setPaintIndex(
 	auto vertex = vertices(vertexIndex, vertexCount);
 	const float value = paintIndex;
 
+	if (mLayout == VERTEX_LAYOUT_SPLIT) {
+		std::fill_n(reinterpret_cast<float*>(vertex.attr()), vertexCount, value);
+		return;
+	}
+
 	for (int i = 0; i < vertexCount; i++) {
 		float *p = reinterpret_cast<float *>(vertex.attr());
 		*p = value;
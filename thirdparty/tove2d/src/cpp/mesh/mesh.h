@@ -25,18 +25,31 @@ typedef uint32_t SubmeshId;
 
 class Submesh;
 
+struct PaintRange {
+	int32_t vertexIndex;
+	int32_t vertexCount;
+	bool line;
+};
+
 class AbstractMesh : public Referencable {
 protected:
 	void *mVertices;
+	uint8_t *mAttributes;
 	int32_t mVertexCount;
+	int32_t mCapacity;
+	uint64_t mAllocations;
 	const uint16_t mStride;
+	const VertexLayout mLayout;
 	std::map<SubmeshId, Submesh*> mSubmeshes;
+	std::vector<Submesh*> mSpareSubmeshes;
 	mutable std::vector<ToveVertexIndex> mCoalescedTriangles;
+	std::vector<PaintRange> mPaintRanges;
 
+	void resize(int32_t capacity);
 	void reserve(int32_t n);
 
 public:
-	AbstractMesh(uint16_t stride);
+	AbstractMesh(uint16_t stride, VertexLayout layout);
 	virtual ~AbstractMesh();
 
 	ToveTrianglesMode getIndexMode() const;
@@ -47,6 +60,11 @@ public:
 		ToveVertexIndex *indices,
 		int32_t indexCount) const;
 
+	void copyIndexData(
+		int32_t *indices,
+		int32_t indexCount,
+		int32_t base) const;
+
 	inline void clip(int n) {
 		mVertexCount = std::min(mVertexCount, n);
 	}
@@ -55,28 +73,81 @@ public:
 		if (from + n > mVertexCount) {
 			reserve(from + n);
 		}
-		return Vertices(mVertices, mStride, from);
+		if (mLayout == VERTEX_LAYOUT_SPLIT) {
+			return Vertices(mVertices, mAttributes, getAttributeSize(), from);
+		} else {
+			return Vertices(mVertices, mStride, from);
+		}
 	}
 
 	void cache(bool keyframe);
 	void clear();
 	void clearTriangles();
 
+	// empties the mesh like clear(), but keeps vertex and index storage
+	// around for the next tessellation.
+	void recycle();
+	// gives back storage not used by the current contents.
+	void shrinkToFit();
+
+	// number of times vertex or index storage was (re)allocated.
+	uint64_t getAllocationCount() const;
+
+	inline int32_t getVertexCapacity() const {
+		return mCapacity;
+	}
+
 	virtual void setLineColor(
 		const PathRef &path, int vertexIndex, int vertexCount);
 	virtual void setFillColor(
 		const PathRef &path, int vertexIndex, int vertexCount);
 
+	// vertex ranges painted since the last clear(), recycle() or
+	// clearPaintRanges(), so that they can be repainted later on without
+	// tesselating again.
+	inline const std::vector<PaintRange> &getPaintRanges() const {
+		return mPaintRanges;
+	}
+
+	inline void clearPaintRanges() {
+		mPaintRanges.clear();
+	}
+
 	inline int getVertexCount() const {
 		return mVertexCount;
 	}
 
-	inline void copyVertexData(void *buffer, size_t bufferByteSize) {
-		const size_t size = mStride * mVertexCount;
-		assert(bufferByteSize == size);
-		std::memcpy(buffer, mVertices, size);
+	inline VertexLayout getLayout() const {
+		return mLayout;
+	}
+
+	// bytes of color or paint data per vertex.
+	inline uint16_t getAttributeSize() const {
+		return mStride - sizeof(vec2);
+	}
+
+	// views of the vertex data in place, valid until the mesh grows. with
+	// VERTEX_LAYOUT_SPLIT, positions are packed vec2s and attributes are
+	// packed getAttributeSize() byte records.
+	inline const vec2 *getPositionData() const {
+		return reinterpret_cast<const vec2*>(mVertices);
 	}
 
+	inline uint16_t getPositionStride() const {
+		return mLayout == VERTEX_LAYOUT_SPLIT ? sizeof(vec2) : mStride;
+	}
+
+	inline const uint8_t *getAttributeData() const {
+		return mLayout == VERTEX_LAYOUT_SPLIT ? mAttributes :
+			reinterpret_cast<const uint8_t*>(mVertices) + sizeof(vec2);
+	}
+
+	inline uint16_t getAttributeStride() const {
+		return mLayout == VERTEX_LAYOUT_SPLIT ? getAttributeSize() : mStride;
+	}
+
+	void copyVertexData(void *buffer, size_t bufferByteSize);
+
 	Submesh *submesh(const PathRef &path, int line);
 };
 
@@ -104,9 +175,25 @@ public:
 		mTriangles.copyIndexData(indices, indexCount);
 	}
 
+	inline void copyIndexData(
+		int32_t *indices,
+		int32_t indexCount,
+		int32_t base) const {
+
+		mTriangles.copyIndexData(indices, indexCount, base);
+	}
+
 	void cache(bool keyframe);
 	void clearTriangles();
 
+	inline void shrinkToFit() {
+		mTriangles.shrinkToFit();
+	}
+
+	inline uint64_t getAllocationCount() const {
+		return mTriangles.getAllocationCount();
+	}
+
 	inline Vertices vertices(int from, int n) {
 		return mMesh->vertices(from, n);
 	}
@@ -115,7 +202,8 @@ public:
 	void addClipperPaths(
 		const ClipperPaths &paths,
 		float scale,
-		ToveHoles holes);
+		ToveHoles holes,
+		ToveTriangulation triangulation = TOVE_TRIANGULATION_EAR_CLIPPING);
 
 	// used by fixed flattener.
 	void triangulateFixedResolutionFill(
@@ -142,7 +230,7 @@ public:
 
 class Mesh : public AbstractMesh {
 public:
-	Mesh();
+	Mesh(VertexLayout layout = VERTEX_LAYOUT_INTERLEAVED);
 };
 
 class ColorMesh : public AbstractMesh {
@@ -151,7 +239,7 @@ protected:
 		const MeshPaint &paint);
 
 public:
-	ColorMesh();
+	ColorMesh(VertexLayout layout = VERTEX_LAYOUT_INTERLEAVED);
 
 	virtual void setLineColor(
 		const PathRef &path, int vertexIndex, int vertexCount);
@@ -165,7 +253,7 @@ protected:
 		int paintIndex, int vertexIndex, int vertexCount);
 
 public:
-	PaintMesh();
+	PaintMesh(VertexLayout layout = VERTEX_LAYOUT_INTERLEAVED);
 
 	virtual void setLineColor(
 		const PathRef &path, int vertexIndex, int vertexCount);
@@ -68,37 +68,64 @@ ToveMeshUpdateFlags AbstractTesselator::graphicsToMesh(
 }
 
 
-static void clip(
-	const Graphics *graphics,
+void AdaptiveTesselator::clip(
 	const PathRef &path,
-	ClipperPaths &subject) {
+	ClipperPaths &subject) const {
 
 #ifdef NSVG_CLIP_PATHS
 	const std::vector<TOVEclipPathIndex> &clipIndices =
 		path->getClipIndices();
 
-	if (!clipIndices.empty()) {
-		for (TOVEclipPathIndex i : clipIndices) {
-			ClipperLib::Clipper c;
-			c.AddPaths(
-				subject,
-				ClipperLib::ptSubject,
-				true);
-			c.AddPaths(
-				graphics->getClipAtIndex(i)->computed,
-				ClipperLib::ptClip,
-				true);
-			c.Execute(
-				ClipperLib::ctIntersection,
-				subject);
+	for (TOVEclipPathIndex i : clipIndices) {
+		if (i >= clipPaths.size()) {
+			// the path was taken out of the graphics that held its clips.
+			continue;
 		}
+		ClipperLib::Clipper c;
+		c.AddPaths(
+			subject,
+			ClipperLib::ptSubject,
+			true);
+		c.AddPaths(
+			clipPaths[i],
+			ClipperLib::ptClip,
+			true);
+		c.Execute(
+			ClipperLib::ctIntersection,
+			subject);
 	}
 #endif
 }
 
+#ifdef NSVG_CLIP_PATHS
+void AdaptiveTesselator::computeClipPaths(
+	const ClipSetRef &clips,
+	float scale) {
+
+	if (clips == clipSet && scale == clipScale) {
+		return;
+	}
+
+	clipSet = clips;
+	clipScale = scale;
+	clipPaths.clear();
+
+	if (clips) {
+		for (const ClipRef &c : clips->getClips()) {
+			clipPaths.push_back(toClipPath(c->paths));
+		}
+	}
+}
+#endif
+
 AdaptiveTesselator::AdaptiveTesselator(
-	AbstractAdaptiveFlattener *flattener) :
-	flattener(flattener) {
+	AbstractAdaptiveFlattener *flattener,
+	ToveTriangulation triangulation) :
+	flattener(flattener),
+	triangulation(triangulation) {
+#ifdef NSVG_CLIP_PATHS
+	clipScale = 0.0f;
+#endif
 }
 
 AdaptiveTesselator::~AdaptiveTesselator() {
@@ -113,7 +140,9 @@ void AdaptiveTesselator::beginTesselate(
 
 	flattener->configure(scale);
 
-	graphics->computeClipPaths(*this);
+#ifdef NSVG_CLIP_PATHS
+	computeClipPaths(graphics->getClipSet(), scale);
+#endif
 }
 
 bool AdaptiveTesselator::hasFixedSize() const {
@@ -141,9 +170,10 @@ void AdaptiveTesselator::renderStrokes(
 			ClipperPaths paths;
 			paths.push_back(node->Contour);
 			paths.insert(paths.end(), holes.begin(), holes.end());
-			clip(graphics, path, paths);
+			clip(path, paths);
 			submesh->addClipperPaths(
-				paths, flattener->getClipperScale(), TOVE_HOLES_CW);
+				paths, flattener->getClipperScale(), TOVE_HOLES_CW,
+				triangulation);
 		}
 		holes.clear();
 	}
@@ -160,6 +190,8 @@ ToveMeshUpdateFlags AdaptiveTesselator::pathToMesh(
 	assert(fillIndex == fill->getVertexCount());
 	assert(lineIndex == line->getVertexCount());
 
+	ScratchArena::Scope scope(scratch);
+
 	const NSVGshape *shape = path->getNSVG();
 
 	if ((shape->flags & NSVG_FLAGS_VISIBLE) == 0) {
@@ -176,11 +208,12 @@ ToveMeshUpdateFlags AdaptiveTesselator::pathToMesh(
 	// ClosedPathsFromPolyTree
 
 	if (!t.fill.empty() && shape->fill.type != NSVG_PAINT_NONE) {
-		clip(graphics, path, t.fill);
+		clip(path, t.fill);
 		const int index0 = fill->getVertexCount();
  		// ClipperLib always gives us TOVE_HOLES_CW.
  		fill->submesh(path, 0)->addClipperPaths(
-			t.fill, flattener->getClipperScale(), TOVE_HOLES_CW);
+			t.fill, flattener->getClipperScale(), TOVE_HOLES_CW,
+			triangulation);
 		fill->setFillColor(path, index0, fill->getVertexCount() - index0);
 	}
 
@@ -237,6 +270,8 @@ ToveMeshUpdateFlags RigidTesselator::pathToMesh(
 	int &fillIndex,
 	int &lineIndex) {
 
+	ScratchArena::Scope scope(scratch);
+
 	NSVGshape *shape = path->getNSVG();
 
 	if ((shape->flags & NSVG_FLAGS_VISIBLE) == 0) {
@@ -14,6 +14,7 @@
 
 #include "../graphics.h"
 #include "paint.h"
+#include "arena.h"
 
 BEGIN_TOVE_NAMESPACE
 
@@ -21,6 +22,9 @@ class AbstractTesselator {
 protected:
 	const Graphics *graphics;
 
+	// clipping and triangulation scratch, reset after every pathToMesh().
+	ScratchArena scratch;
+
 public:
 	ToveMeshUpdateFlags graphicsToMesh(
 		Graphics *graphics,
@@ -63,10 +67,25 @@ private:
 		Submesh *submesh);
 
 	AbstractAdaptiveFlattener *flattener;
+	ToveTriangulation triangulation;
+
+#ifdef NSVG_CLIP_PATHS
+	// the clip set flattened at clipScale. clip sets are immutable, so this
+	// only needs to be redone for another clip set or scale, not for every
+	// beginTesselate().
+	ClipSetRef clipSet;
+	float clipScale;
+	std::vector<ClipperPaths> clipPaths;
+
+	void computeClipPaths(const ClipSetRef &clips, float scale);
+#endif
+
+	void clip(const PathRef &path, ClipperPaths &subject) const;
 
 public:
 	AdaptiveTesselator(
-		AbstractAdaptiveFlattener *flattener);
+		AbstractAdaptiveFlattener *flattener,
+		ToveTriangulation triangulation = TOVE_TRIANGULATION_EAR_CLIPPING);
 
 	virtual ~AdaptiveTesselator();
 
@@ -86,6 +105,10 @@ public:
 		const std::vector<PathRef> &paths) const;
 
 	virtual bool hasFixedSize() const;
+
+	inline ToveTriangulation getTriangulation() const {
+		return triangulation;
+	}
 };
 
 class RigidTesselator : public AbstractTesselator {
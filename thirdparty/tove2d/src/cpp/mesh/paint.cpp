@@ -0,0 +1,157 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "paint.h"
+#include <cassert>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TOVE_GRADIENT_SSE2 1
+#include <emmintrin.h>
+#ifndef NDEBUG
+// debug builds check every vectorized vertex against the scalar path.
+#define TOVE_GRADIENT_CHECK 1
+#endif
+#endif
+
+BEGIN_TOVE_NAMESPACE
+
+inline void storeColor(uint8_t *colors, int color) {
+	*colors++ = (color >> 0) & 0xff;
+	*colors++ = (color >> 8) & 0xff;
+	*colors++ = (color >> 16) & 0xff;
+	*colors++ = (color >> 24) & 0xff;
+}
+
+#if TOVE_GRADIENT_SSE2
+// the vector paths below mirror the scalar expressions operation by
+// operation (no reassociation, no reciprocal for the division), so each
+// lane rounds exactly like its scalar counterpart.
+
+inline void loadXY(const Vertices &vertex, __m128 &x, __m128 &y) {
+	const vec2 &v0 = *vertex;
+	const vec2 &v1 = *(vertex + 1);
+	const vec2 &v2 = *(vertex + 2);
+	const vec2 &v3 = *(vertex + 3);
+	x = _mm_setr_ps(v0.x, v1.x, v2.x, v3.x);
+	y = _mm_setr_ps(v0.y, v1.y, v2.y, v3.y);
+}
+
+inline void storeColors(
+	Vertices &vertex, const uint32_t *colors, __m128 g) {
+
+	// clamp(g * 255, 0, 255) as max(min(...)), then truncate.
+	g = _mm_mul_ps(g, _mm_set1_ps(255.0f));
+	g = _mm_max_ps(_mm_min_ps(g, _mm_set1_ps(255.0f)), _mm_setzero_ps());
+
+	alignas(16) int32_t index[4];
+	_mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvttps_epi32(g));
+
+	for (int k = 0; k < 4; k++) {
+		storeColor(vertex.attr(), colors[index[k]]);
+		vertex++;
+	}
+}
+#endif
+
+#if TOVE_GRADIENT_CHECK
+template<typename F>
+void checkColors(const Vertices &vertices, int n, const F &scalar) {
+	Vertices vertex(vertices);
+	for (int i = 0; i < n; i++) {
+		uint8_t expected[4];
+		storeColor(expected, scalar(vertex->x, vertex->y));
+		assert(std::memcmp(vertex.attr(), expected, 4) == 0);
+		vertex++;
+	}
+}
+#endif
+
+void MeshPaint::getLinearGradientColors(const Vertices &vertices, int n) const {
+	Vertices vertex(vertices);
+	int i = 0;
+
+#if TOVE_GRADIENT_SSE2
+	const float *t = cache.xform;
+	const __m128 s = _mm_set1_ps(scale);
+	const __m128 t1 = _mm_set1_ps(t[1]);
+	const __m128 t3 = _mm_set1_ps(t[3]);
+	const __m128 t5 = _mm_set1_ps(t[5]);
+
+	for (; i + 4 <= n; i += 4) {
+		__m128 x, y;
+		loadXY(vertex, x, y);
+		x = _mm_div_ps(x, s);
+		y = _mm_div_ps(y, s);
+
+		const __m128 gy = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x, t1), _mm_mul_ps(y, t3)), t5);
+		storeColors(vertex, cache.colors, gy);
+	}
+#endif
+
+#if TOVE_GRADIENT_CHECK
+	checkColors(vertices, i, [this](float x, float y) {
+		return getLinearGradientColor(x, y);
+	});
+#endif
+
+	for (; i < n; i++) {
+		storeColor(vertex.attr(),
+			getLinearGradientColor(vertex->x, vertex->y));
+		vertex++;
+	}
+}
+
+void MeshPaint::getRadialGradientColors(const Vertices &vertices, int n) const {
+	Vertices vertex(vertices);
+	int i = 0;
+
+#if TOVE_GRADIENT_SSE2
+	const float *t = cache.xform;
+	const __m128 s = _mm_set1_ps(scale);
+	const __m128 t0 = _mm_set1_ps(t[0]);
+	const __m128 t1 = _mm_set1_ps(t[1]);
+	const __m128 t2 = _mm_set1_ps(t[2]);
+	const __m128 t3 = _mm_set1_ps(t[3]);
+	const __m128 t4 = _mm_set1_ps(t[4]);
+	const __m128 t5 = _mm_set1_ps(t[5]);
+
+	for (; i + 4 <= n; i += 4) {
+		__m128 x, y;
+		loadXY(vertex, x, y);
+		x = _mm_div_ps(x, s);
+		y = _mm_div_ps(y, s);
+
+		const __m128 gx = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x, t0), _mm_mul_ps(y, t2)), t4);
+		const __m128 gy = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(x, t1), _mm_mul_ps(y, t3)), t5);
+		const __m128 gd = _mm_sqrt_ps(
+			_mm_add_ps(_mm_mul_ps(gx, gx), _mm_mul_ps(gy, gy)));
+		storeColors(vertex, cache.colors, gd);
+	}
+#endif
+
+#if TOVE_GRADIENT_CHECK
+	checkColors(vertices, i, [this](float x, float y) {
+		return getRadialGradientColor(x, y);
+	});
+#endif
+
+	for (; i < n; i++) {
+		storeColor(vertex.attr(),
+			getRadialGradientColor(vertex->x, vertex->y));
+		vertex++;
+	}
+}
+
+END_TOVE_NAMESPACE
@@ -14,6 +14,7 @@
 
 #include "../nsvg.h"
 #include "../utils.h"
+#include "utils.h"
 
 BEGIN_TOVE_NAMESPACE
 
@@ -55,6 +56,12 @@ public:
 		const float gd = sqrtf(gx * gx + gy * gy);
 		return cache.colors[(int)clamp(gd * 255.0f, 0, 255.0f)];
 	}
+
+	// write gradient colors into the attribute bytes of n vertices. these
+	// evaluate several vertices at once where SIMD is available, and give
+	// the same bits as calling the functions above per vertex.
+	void getLinearGradientColors(const Vertices &vertices, int n) const;
+	void getRadialGradientColors(const Vertices &vertices, int n) const;
 };
 
 END_TOVE_NAMESPACE
@@ -13,7 +13,7 @@
 
 BEGIN_TOVE_NAMESPACE
 
-Partition::Partition(const std::list<ToveTPPLPoly> &convex) {
+Partition::Partition(const TPPLPolyList &convex) {
     parts.reserve(convex.size());
 
     for (auto i = convex.begin(); i != convex.end(); i++) {
@@ -33,7 +33,7 @@ public:
 	inline Partition() {
 	}
 
-	Partition(const std::list<ToveTPPLPoly> &convex);
+	Partition(const TPPLPolyList &convex);
 
 	inline bool empty() const {
 		return parts.empty();
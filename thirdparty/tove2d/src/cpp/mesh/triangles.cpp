@@ -19,20 +19,42 @@ ToveVertexIndex *TriangleStore::allocate(int n, bool isFinalSize) {
     const int k = (mMode == TRIANGLES_LIST) ? 3 : 1;
     mSize += n * k;
 
-    const int count = isFinalSize ? mSize : nextpow2(mSize);
-    mTriangles = static_cast<ToveVertexIndex*>(realloc(
-        mTriangles, count * sizeof(ToveVertexIndex)));
-
-    if (!mTriangles) {
-        TOVE_BAD_ALLOC();
-        return nullptr;
+    if (mSize > mCapacity) {
+        mCapacity = isFinalSize ? mSize : nextpow2(mSize);
+        mTriangles = static_cast<ToveVertexIndex*>(realloc(
+            mTriangles, mCapacity * sizeof(ToveVertexIndex)));
+        mAllocations++;
+
+        if (!mTriangles) {
+            TOVE_BAD_ALLOC();
+            return nullptr;
+        }
     }
 
     return &mTriangles[offset];
 }
 
+void TriangleStore::shrinkToFit() {
+    if (mCapacity == mSize) {
+        return;
+    }
+
+    mCapacity = mSize;
+    if (mSize == 0) {
+        free(mTriangles);
+        mTriangles = nullptr;
+    } else {
+        mTriangles = static_cast<ToveVertexIndex*>(realloc(
+            mTriangles, mCapacity * sizeof(ToveVertexIndex)));
+        if (!mTriangles) {
+            TOVE_BAD_ALLOC();
+        }
+        mAllocations++;
+    }
+}
+
 void TriangleStore::_add(
-    const std::list<ToveTPPLPoly> &triangles,
+    const TPPLPolyList &triangles,
     bool isFinalSize) {
 
     ToveVertexIndex *indices = allocate(triangles.size(), isFinalSize);
@@ -81,12 +103,27 @@ void TriangleCache::evict() {
     }
 
     if (minIndex >= 0) {
+        allocations += triangulations[minIndex]->triangles.getAllocationCount();
         delete triangulations[minIndex];
         triangulations.erase(triangulations.begin() + minIndex);
         current = std::min(current, (int)(triangulations.size() - 1));
     }
 }
 
+void TriangleCache::shrinkToFit() {
+    for (Triangulation *t : triangulations) {
+        t->triangles.shrinkToFit();
+    }
+}
+
+uint64_t TriangleCache::getAllocationCount() const {
+    uint64_t count = allocations;
+    for (const Triangulation *t : triangulations) {
+        count += t->triangles.getAllocationCount();
+    }
+    return count;
+}
+
 bool TriangleCache::findCachedTriangulation(
     const Vertices &vertices, bool &trianglesChanged) {
     
@@ -34,6 +34,8 @@ inline ToveVertexIndex ToLoveVertexMapIndex(ToveVertexIndex i) {
 class TriangleStore {
 private:
 	int32_t mSize;
+	int32_t mCapacity;
+	uint64_t mAllocations;
 	ToveVertexIndex *mTriangles;
 
 public:
@@ -43,7 +45,7 @@ public:
 
 private:
 	void _add(
-		const std::list<ToveTPPLPoly> &triangles,
+		const TPPLPolyList &triangles,
 		bool isFinalSize);
 
 	void _add(
@@ -53,7 +55,7 @@ private:
 
 public:
 	inline TriangleStore(ToveTrianglesMode mode) :
-		mSize(0), mTriangles(nullptr), mMode(mode) {
+		mSize(0), mCapacity(0), mAllocations(0), mTriangles(nullptr), mMode(mode) {
 	}
 
 	inline ~TriangleStore() {
@@ -62,13 +64,13 @@ public:
 		}
 	}
 
-	inline TriangleStore(const std::list<ToveTPPLPoly> &triangles) :
-		mSize(0), mTriangles(nullptr), mMode(TRIANGLES_LIST) {
+	inline TriangleStore(const TPPLPolyList &triangles) :
+		mSize(0), mCapacity(0), mAllocations(0), mTriangles(nullptr), mMode(TRIANGLES_LIST) {
 
 		_add(triangles, true);
 	}
 
-	inline void add(const std::list<ToveTPPLPoly> &triangles) {
+	inline void add(const TPPLPolyList &triangles) {
 		assert(mMode == TRIANGLES_LIST);
 		_add(triangles, false);
 	}
@@ -82,6 +84,12 @@ public:
 		mSize = 0;
 	}
 
+	void shrinkToFit();
+
+	inline uint64_t getAllocationCount() const {
+		return mAllocations;
+	}
+
 	inline size_t size() const {
 		return mSize;
 	}
@@ -100,13 +108,25 @@ public:
 				n * sizeof(ToveVertexIndex));
 		}
 	}
+
+	// widens into 32-bit indices, adding base.
+	inline void copy(
+		int32_t *indices,
+		int32_t indexCount,
+		int32_t base) const {
+
+		const int32_t n = std::min(mSize, indexCount);
+		for (int32_t i = 0; i < n; i++) {
+			indices[i] = base + mTriangles[i];
+		}
+	}
 };
 
 struct Triangulation {
 	inline Triangulation(ToveTrianglesMode mode) : triangles(mode) {
 	}
 
-	inline Triangulation(const std::list<ToveTPPLPoly> &convex) :
+	inline Triangulation(const TPPLPolyList &convex) :
 		partition(convex),
 		triangles(TRIANGLES_LIST),
 		useCount(0),
@@ -128,6 +148,7 @@ private:
 	std::vector<Triangulation*> triangulations;
 	int current;
 	int cacheSize;
+	uint64_t allocations;
 
 	void evict();
 
@@ -138,7 +159,7 @@ private:
 
 public:
 	inline TriangleCache(int p_cacheSize = 2) :
-		current(0), cacheSize(p_cacheSize) {
+		current(0), cacheSize(p_cacheSize), allocations(0) {
 		assert(cacheSize >= 2);
 	}
 
@@ -174,15 +195,17 @@ public:
 	inline ToveVertexIndex *allocate(ToveTrianglesMode mode, int n) {
 		if (triangulations.empty()) {
 			triangulations.push_back(new Triangulation(mode));
+			allocations++;
 		} else {
 			assert(triangulations[current]->getMode() == mode);
 		}
 		return currentTriangulation()->triangles.allocate(n);
 	}
 
-	inline void add(const std::list<ToveTPPLPoly> &triangles) {
+	inline void add(const TPPLPolyList &triangles) {
 		if (triangulations.empty()) {
 			triangulations.push_back(new Triangulation(TRIANGLES_LIST));
+			allocations++;
 		}
 		currentTriangulation()->triangles.add(triangles);
 	}
@@ -191,6 +214,7 @@ public:
 		ToveVertexIndex i0) {
 		if (triangulations.empty()) {
 			triangulations.push_back(new Triangulation(TRIANGLES_LIST));
+			allocations++;
 		}
 		currentTriangulation()->triangles.add(triangles, i0);
 	}
@@ -201,6 +225,9 @@ public:
 		}
 	}
 
+	void shrinkToFit();
+	uint64_t getAllocationCount() const;
+
 	inline ToveTrianglesMode getIndexMode() const {
 		if (current < (int32_t)triangulations.size()) {
 			return triangulations[current]->triangles.mode();
@@ -227,6 +254,17 @@ public:
 		}
 	}
 
+	inline void copyIndexData(
+		int32_t *indices,
+		int32_t indexCount,
+		int32_t base) const {
+
+		if (current < (int32_t)triangulations.size()) {
+			auto &t = triangulations[current]->triangles;
+			t.copy(indices, indexCount, base);
+		}
+	}
+
 	bool findCachedTriangulation(
 		const Vertices &vertices, bool &trianglesChanged);
 };
@@ -23,20 +23,42 @@ struct vec2 {
 	inline vec2(float p_x, float p_y) : x(p_x), y(p_y) { };
 };
 
+// how a mesh stores its vertices: interleaved keeps each vertex's
+// attributes (color or paint index) right after its position; split keeps
+// all positions in one array and all attributes in another.
+enum VertexLayout {
+	VERTEX_LAYOUT_INTERLEAVED,
+	VERTEX_LAYOUT_SPLIT
+};
+
 class Vertices {
 private:
     void *vertices;
+    uint8_t *attributes;
     const uint16_t stride;
+    const uint16_t attributeStride;
 
 public:
 	inline Vertices(void *p_vertices, uint16_t p_stride, size_t p_i0 = 0) :
         vertices(reinterpret_cast<uint8_t*>(p_vertices) + (p_i0 * p_stride)),
-        stride(p_stride) {
+        attributes(reinterpret_cast<uint8_t*>(vertices) + sizeof(vec2)),
+        stride(p_stride),
+        attributeStride(p_stride) {
+	}
+
+	inline Vertices(void *p_positions, void *p_attributes,
+        uint16_t p_attributeStride, size_t p_i0 = 0) :
+        vertices(reinterpret_cast<vec2*>(p_positions) + p_i0),
+        attributes(reinterpret_cast<uint8_t*>(p_attributes) + (p_i0 * p_attributeStride)),
+        stride(sizeof(vec2)),
+        attributeStride(p_attributeStride) {
 	}
 
 	inline Vertices(const Vertices &v) :
         vertices(v.vertices),
-        stride(v.stride) {
+        attributes(v.attributes),
+        stride(v.stride),
+        attributeStride(v.attributeStride) {
 	}
 
 	inline vec2 &operator[](size_t i) const {
@@ -50,8 +72,10 @@ public:
 	}
 
 	inline Vertices operator+(size_t i) const {
-		return Vertices(
-			reinterpret_cast<uint8_t*>(vertices) + stride * i, stride);
+		Vertices v(*this);
+		v.vertices = reinterpret_cast<uint8_t*>(vertices) + stride * i;
+		v.attributes = attributes + attributeStride * i;
+		return v;
 	}
 
 	inline vec2* operator->() const {
@@ -59,11 +83,12 @@ public:
 	}
 
     inline uint8_t *attr() const {
-        return reinterpret_cast<uint8_t*>(vertices) + sizeof(vec2);
+        return attributes;
     }
 
 	inline Vertices& operator++() { // prefix
 		vertices = reinterpret_cast<uint8_t*>(vertices) + stride;
+		attributes += attributeStride;
 		return *this;
 	}
 
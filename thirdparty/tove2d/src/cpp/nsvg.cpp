@@ -32,9 +32,31 @@ BEGIN_TOVE_NAMESPACE
 
 namespace nsvg {
 
-thread_local NSVGparser *_parser = nullptr;
-thread_local NSVGrasterizer *rasterizer = nullptr;
-thread_local ToveRasterizeSettings defaultSettings = {-1.0f, -1.0f};
+// scratch state for rasterization and stroke flattening. unlike parsing,
+// nothing outside this file rasterizes often enough to pool these, so
+// there is just one per thread, bounded like a ParseContext.
+class RasterContext {
+	NSVGrasterizer *rasterizer;
+	const size_t retainLimit;
+
+	size_t getRetainedBytes() const;
+
+public:
+	RasterContext(size_t retainLimit);
+	~RasterContext();
+
+	RasterContext(const RasterContext&) = delete;
+	RasterContext &operator=(const RasterContext&) = delete;
+
+	NSVGrasterizer *begin(const ToveRasterizeSettings *settings);
+	void end();
+	void reset();
+};
+
+// the fallback for callers that don't pass a parse context, and the
+// rasterizer. both get freed on thread exit.
+thread_local ParseContext defaultParseContext;
+thread_local RasterContext defaultRasterContext(1024 * 1024);
 
 // scoping the locale should no longer be necessary.
 #define NSVG_SCOPE_LOCALE 0
@@ -232,43 +254,67 @@ int parseSVG(
 
 } // bridge
 
-NSVGimage *parseSVG(const char *svg, const char *units, float dpi) {
-	const NanoSVGEnvironment env;
-	// we know that our own bridge::parseSVG won't destroy the svg input
-	// text, so it's safe to const_cast here.
-	return nsvgParseEx(const_cast<char*>(svg), units, dpi, bridge::parseSVG);
+ParseContext::ParseContext(size_t retainLimit) :
+	parser(nullptr), retainLimit(retainLimit) {
 }
 
-static NSVGrasterizer *ensureRasterizer() {
-	if (!rasterizer) {
-		rasterizer = nsvgCreateRasterizer();
-	}
-	return rasterizer;
+ParseContext::~ParseContext() {
+	reset();
 }
 
-const ToveRasterizeSettings *getDefaultRasterizeSettings() {
-
-	if (defaultSettings.tessTolerance < 0.0f) {
-		rasterizer = ensureRasterizer();
-		if (!rasterizer) {
+NSVGparser *ParseContext::begin() {
+	if (!parser) {
+		parser = nsvg__createParser();
+		if (!parser) {
+			TOVE_BAD_ALLOC();
 			return nullptr;
 		}
+	} else {
+		nsvg__resetPath(parser);
+	}
+	return parser;
+}
+
+void ParseContext::end() {
+	if (!parser) {
+		return;
+	}
+	if (getRetainedBytes() > retainLimit || !nsvg__recycleParser(parser)) {
+		reset();
+	}
+}
 
-		defaultSettings.tessTolerance = rasterizer->tessTol;
-		defaultSettings.distTolerance = rasterizer->distTol;
+void ParseContext::reset() {
+	if (parser) {
+		nsvg__deleteParser(parser);
+		parser = nullptr;
 	}
+}
 
-	return &defaultSettings;
+size_t ParseContext::getRetainedBytes() const {
+	if (!parser) {
+		return 0;
+	}
+	return sizeof(NSVGparser) + sizeof(NSVGimage) +
+		size_t(parser->cpts) * 2 * sizeof(float);
+}
+
+RasterContext::RasterContext(size_t retainLimit) :
+	rasterizer(nullptr), retainLimit(retainLimit) {
 }
 
-static NSVGrasterizer *getRasterizer(
-	const ToveRasterizeSettings *settings) {
+RasterContext::~RasterContext() {
+	reset();
+}
 
-	rasterizer = ensureRasterizer();
+NSVGrasterizer *RasterContext::begin(const ToveRasterizeSettings *settings) {
 	if (!rasterizer) {
-		return nullptr;
+		rasterizer = nsvgCreateRasterizer();
+		if (!rasterizer) {
+			TOVE_BAD_ALLOC();
+			return nullptr;
+		}
 	}
-	// skipping nsvgDeleteRasterizer(rasterizer)
 
 	if (!settings) {
 		settings = getDefaultRasterizeSettings();
@@ -284,17 +330,79 @@ static NSVGrasterizer *getRasterizer(
 	return rasterizer;
 }
 
-static NSVGparser *getNSVGparser() {
-	if (!_parser) {
-		_parser = nsvg__createParser();
-		if (!_parser) {
-			TOVE_BAD_ALLOC();
-			return nullptr;
-		}
-	} else {
-		nsvg__resetPath(_parser);
+void RasterContext::end() {
+	if (!rasterizer) {
+		return;
+	}
+
+	// stencil and dither buffers are reallocated to fit every image
+	// anyway, so there's nothing to gain from keeping them around.
+	free(rasterizer->stencil.data);
+	rasterizer->stencil.data = nullptr;
+	free(rasterizer->dither.data);
+	rasterizer->dither.data = nullptr;
+
+	if (getRetainedBytes() > retainLimit) {
+		reset();
 	}
-	return _parser;
+}
+
+void RasterContext::reset() {
+	if (rasterizer) {
+		nsvgDeleteRasterizer(rasterizer);
+		rasterizer = nullptr;
+	}
+}
+
+size_t RasterContext::getRetainedBytes() const {
+	if (!rasterizer) {
+		return 0;
+	}
+
+	size_t bytes = sizeof(NSVGrasterizer);
+	bytes += size_t(rasterizer->cedges) * sizeof(NSVGedge);
+	bytes += size_t(rasterizer->cpoints) * sizeof(NSVGpoint);
+	bytes += size_t(rasterizer->cpoints2) * sizeof(NSVGpoint);
+	bytes += size_t(rasterizer->cscanline);
+	for (const NSVGmemPage *p = rasterizer->pages; p; p = p->next) {
+		bytes += sizeof(NSVGmemPage);
+	}
+	return bytes;
+}
+
+NSVGimage *parseSVG(const char *svg, const char *units, float dpi,
+	ParseContext *context) {
+
+	const NanoSVGEnvironment env;
+
+	if (!context) {
+		context = &defaultParseContext;
+	}
+	NSVGparser *parser = context->begin();
+	if (!parser) {
+		return nullptr;
+	}
+	parser->dpi = dpi;
+
+	// we know that our own bridge::parseSVG won't destroy the svg input
+	// text, so it's safe to const_cast here.
+	bridge::parseSVG(const_cast<char*>(svg),
+		nsvg__startElement, nsvg__endElement, nsvg__content, parser);
+
+	nsvg__assignGradients(parser);
+	nsvg__scaleToViewbox(parser, units);
+
+	NSVGimage *image = parser->image;
+	parser->image = nullptr;
+
+	context->end();
+	return image;
+}
+
+const ToveRasterizeSettings *getDefaultRasterizeSettings() {
+	// the tolerances nsvgCreateRasterizer() starts out with.
+	static const ToveRasterizeSettings defaultSettings = {0.25f, 0.01f};
+	return &defaultSettings;
 }
 
 uint32_t makeColor(float r, float g, float b, float a) {
@@ -349,28 +457,38 @@ void xformIdentity(float *m) {
 	nsvg__xformIdentity(m);
 }
 
-NSVGimage *parsePath(const char *d) {
+NSVGimage *parsePath(const char *d, ParseContext *context) {
 	const NanoSVGEnvironment env;
 
-	NSVGparser *parser = getNSVGparser();
+	if (!context) {
+		context = &defaultParseContext;
+	}
+	NSVGparser *parser = context->begin();
+	if (!parser) {
+		return nullptr;
+	}
 
 	const char *attr[3] = {"d", d, nullptr};
 	nsvg__parsePath(parser, attr);
 
 	NSVGimage *image = parser->image;
+	parser->image = nullptr;
 
-	parser->image = static_cast<NSVGimage*>(malloc(sizeof(NSVGimage)));
-	if (!parser->image) {
-		TOVE_BAD_ALLOC();
-		return nullptr;
-	}
-	memset(parser->image, 0, sizeof(NSVGimage));
-
+	context->end();
 	return image;
 }
 
-float *pathArcTo(float *cpx, float *cpy, float *args, int &npts) {
-	NSVGparser *parser = getNSVGparser();
+float *pathArcTo(float *cpx, float *cpy, float *args, int &npts,
+	ParseContext *context) {
+
+	if (!context) {
+		context = &defaultParseContext;
+	}
+	NSVGparser *parser = context->begin();
+	if (!parser) {
+		npts = 0;
+		return nullptr;
+	}
 	nsvg__pathArcTo(parser, cpx, cpy, args, 0);
 	npts = parser->npts;
 	return parser->pts;
@@ -402,12 +520,17 @@ bool shapeStrokeBounds(float *bounds, const NSVGshape *shape,
 	// computing the shape stroke bounds is not trivial as miters
 	// might take varying amounts of space.
 
-	NSVGrasterizer *rasterizer = getRasterizer(quality);
+	RasterContext *context = &defaultRasterContext;
+	NSVGrasterizer *rasterizer = context->begin(quality);
+	if (!rasterizer) {
+		return false;
+	}
 	nsvg__flattenShapeStroke(
 		rasterizer, const_cast<NSVGshape*>(shape), scale);
 
 	const int n = rasterizer->nedges;
 	if (n < 1) {
+		context->end();
 		return false;
 	} else {
 		const NSVGedge *edges = rasterizer->edges;
@@ -439,6 +562,8 @@ bool shapeStrokeBounds(float *bounds, const NSVGshape *shape,
 		bounds[1] = by0;
 		bounds[2] = bx1;
 		bounds[3] = by1;
+
+		context->end();
 		return true;
 	}
 }
@@ -447,10 +572,16 @@ void rasterize(NSVGimage *image, float tx, float ty, float scale,
 	uint8_t* pixels, int width, int height, int stride,
 	const ToveRasterizeSettings *quality) {
 
-	NSVGrasterizer *rasterizer = getRasterizer(quality);
+	RasterContext *context = &defaultRasterContext;
+	NSVGrasterizer *rasterizer = context->begin(quality);
+	if (!rasterizer) {
+		return;
+	}
 
 	nsvgRasterize(rasterizer, image, tx, ty, scale,
 			pixels, width, height, stride);
+
+	context->end();
 }
 
 Transform::Transform() {
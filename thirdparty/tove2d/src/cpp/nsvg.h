@@ -18,9 +18,42 @@ BEGIN_TOVE_NAMESPACE
 
 #define NSVG_CLIP_PATHS 1
 
+struct NSVGparser;
+
 namespace nsvg {
 
-NSVGimage *parseSVG(const char *svg, const char *units, float dpi);
+// scratch state for parsing. contexts may be pooled and reused; once a
+// parse leaves more than retainLimit bytes behind, the buffers are
+// released again. calls without a context use a per-thread one.
+class ParseContext {
+	NSVGparser *parser;
+	size_t retainLimit;
+
+public:
+	static constexpr size_t defaultRetainLimit = 256 * 1024;
+
+	ParseContext(size_t retainLimit = defaultRetainLimit);
+	~ParseContext();
+
+	ParseContext(const ParseContext&) = delete;
+	ParseContext &operator=(const ParseContext&) = delete;
+
+	NSVGparser *begin();
+	void end();
+	void reset();
+
+	size_t getRetainedBytes() const;
+
+	inline size_t getRetainLimit() const {
+		return retainLimit;
+	}
+	inline void setRetainLimit(size_t limit) {
+		retainLimit = limit;
+	}
+};
+
+NSVGimage *parseSVG(const char *svg, const char *units, float dpi,
+	ParseContext *context = nullptr);
 
 uint32_t makeColor(float r, float g, float b, float a);
 uint32_t applyOpacity(uint32_t color, float opacity);
@@ -76,8 +109,10 @@ public:
 void xformInverse(float *a, float *b);
 void xformIdentity(float *m);
 
-float *pathArcTo(float *cpx, float *cpy, float *args, int &npts);
-NSVGimage *parsePath(const char *d);
+// the returned points live in the context and stay valid until its next use.
+float *pathArcTo(float *cpx, float *cpy, float *args, int &npts,
+	ParseContext *context = nullptr);
+NSVGimage *parsePath(const char *d, ParseContext *context = nullptr);
 
 struct CachedPaint {
 	char type;
@@ -99,6 +134,8 @@ struct CachedPaint {
 
 const ToveRasterizeSettings *getDefaultRasterizeSettings();
 
+// both use a per-thread rasterizer whose buffers are released once they
+// grow past a limit.
 bool shapeStrokeBounds(float *bounds, const NSVGshape *shape,
 	float scale, const ToveRasterizeSettings *settings);
 
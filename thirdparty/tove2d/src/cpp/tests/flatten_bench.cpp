@@ -0,0 +1,207 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// compares WangCurveFlattener against the recursive flatteners
+// (DefaultCurveFlattener, AntiGrainFlattener) set up the way
+// VGMeshRenderer sets them up for a given quality: points per cubic, the
+// largest and mean distance of the curve from its polyline in pixels, and
+// time per cubic. curves come in three kinds, since an upfront segment
+// count and adaptive subdivision part ways on uneven curves.
+//
+// built by the SConstruct here; ./bin/flatten_bench [curves=2000] [runs=100]
+
+#include "../mesh/flatten.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace tove;
+
+struct Cubic {
+	float c[8];
+};
+
+// random control points over a 200 px square.
+static std::vector<Cubic> makeRandom(int n, std::mt19937 &rng) {
+	std::uniform_real_distribution<float> d(0, 200);
+	std::vector<Cubic> curves(n);
+	for (Cubic &curve : curves) {
+		for (float &v : curve.c) {
+			v = d(rng);
+		}
+	}
+	return curves;
+}
+
+// long, nearly straight arcs, as in outlines of large shapes.
+static std::vector<Cubic> makeShallow(int n, std::mt19937 &rng) {
+	std::uniform_real_distribution<float> d(0, 200);
+	std::uniform_real_distribution<float> bend(-10, 10);
+	std::vector<Cubic> curves(n);
+	for (Cubic &curve : curves) {
+		const float x1 = d(rng), y1 = d(rng), x4 = d(rng), y4 = d(rng);
+		curve.c[0] = x1;
+		curve.c[1] = y1;
+		curve.c[2] = x1 + (x4 - x1) / 3 + bend(rng);
+		curve.c[3] = y1 + (y4 - y1) / 3 + bend(rng);
+		curve.c[4] = x1 + 2 * (x4 - x1) / 3 + bend(rng);
+		curve.c[5] = y1 + 2 * (y4 - y1) / 3 + bend(rng);
+		curve.c[6] = x4;
+		curve.c[7] = y4;
+	}
+	return curves;
+}
+
+// cusps and tight loops: the middle control points cross over, so one part
+// of the curve is far more bent than the rest.
+static std::vector<Cubic> makeSharp(int n, std::mt19937 &rng) {
+	std::uniform_real_distribution<float> d(0, 200);
+	std::uniform_real_distribution<float> jitter(-5, 5);
+	std::vector<Cubic> curves(n);
+	for (Cubic &curve : curves) {
+		const float x1 = d(rng), y1 = d(rng), x4 = d(rng), y4 = d(rng);
+		curve.c[0] = x1;
+		curve.c[1] = y1;
+		curve.c[2] = x4 + jitter(rng);
+		curve.c[3] = y4 + jitter(rng);
+		curve.c[4] = x1 + jitter(rng);
+		curve.c[5] = y1 + jitter(rng);
+		curve.c[6] = x4;
+		curve.c[7] = y4;
+	}
+	return curves;
+}
+
+static double distanceToPolyline(double x, double y, const ClipperPath &path) {
+	double best = 1e300;
+	for (size_t i = 0; i + 1 < path.size(); i++) {
+		const double ax = path[i].X, ay = path[i].Y;
+		const double dx = path[i + 1].X - ax, dy = path[i + 1].Y - ay;
+		const double l = dx * dx + dy * dy;
+		double t = l > 0 ? ((x - ax) * dx + (y - ay) * dy) / l : 0;
+		t = std::max(0.0, std::min(1.0, t));
+		const double ex = ax + t * dx - x, ey = ay + t * dy - y;
+		best = std::min(best, ex * ex + ey * ey);
+	}
+	return std::sqrt(best);
+}
+
+struct Result {
+	double points; // per curve
+	double maxError; // px
+	double meanError; // px
+	double nanoseconds; // per curve
+};
+
+template<typename Flattener>
+static Result measure(Flattener flattener, const std::vector<Cubic> &curves, int runs) {
+	const float scale = flattener.configure(1.0f).scale;
+
+	std::vector<Cubic> scaled(curves);
+	for (Cubic &curve : scaled) {
+		for (float &v : curve.c) {
+			v *= scale;
+		}
+	}
+
+	Result result = {0, 0, 0, 0};
+	ClipperPath path;
+	const int samples = 64;
+	for (const Cubic &curve : scaled) {
+		const float *c = curve.c;
+		// as AdaptiveFlattener does it: the curve flattener leaves the end
+		// points to the caller.
+		path.clear();
+		path.push_back(ClipperPoint(c[0], c[1]));
+		flattener.flatten(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], path, 0);
+		path.push_back(ClipperPoint(c[6], c[7]));
+		result.points += path.size();
+
+		for (int s = 0; s <= samples; s++) {
+			const double t = s / double(samples), u = 1 - t;
+			const double x = u * u * u * c[0] + 3 * u * u * t * c[2] +
+				3 * u * t * t * c[4] + t * t * t * c[6];
+			const double y = u * u * u * c[1] + 3 * u * u * t * c[3] +
+				3 * u * t * t * c[5] + t * t * t * c[7];
+			const double error = distanceToPolyline(x, y, path) / scale;
+			result.maxError = std::max(result.maxError, error);
+			result.meanError += error;
+		}
+	}
+	result.points /= scaled.size();
+	result.meanError /= scaled.size() * (samples + 1);
+
+	const auto t0 = std::chrono::steady_clock::now();
+	size_t sink = 0;
+	for (int r = 0; r < runs; r++) {
+		for (const Cubic &curve : scaled) {
+			const float *c = curve.c;
+			path.clear();
+			flattener.flatten(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], path, 0);
+			sink += path.size();
+		}
+	}
+	const double ns = std::chrono::duration<double, std::nano>(
+		std::chrono::steady_clock::now() - t0).count();
+	result.nanoseconds = ns / (double(runs) * scaled.size());
+	if (sink == 0) {
+		printf("no points\n");
+	}
+	return result;
+}
+
+static void print(const char *name, const Result &r) {
+	printf("    %-10s %6.1f points %7.3f px max %7.3f px mean %8.1f ns\n",
+		name, r.points, r.maxError, r.meanError, r.nanoseconds);
+}
+
+int main(int argc, char **argv) {
+	const int numCurves = argc > 1 ? atoi(argv[1]) : 2000;
+	const int runs = argc > 2 ? atoi(argv[2]) : 100;
+
+	std::mt19937 rng(3);
+	struct Kind {
+		const char *name;
+		std::vector<Cubic> curves;
+	} kinds[] = {
+		{"random", makeRandom(numCurves, rng)},
+		{"shallow", makeShallow(numCurves, rng)},
+		{"sharp", makeSharp(numCurves, rng)}};
+
+	const float qualities[] = {0.5f, 1.0f, 2.0f};
+	for (float quality : qualities) {
+		// as in VGMeshRenderer::make_tesselator().
+		AntiGrainSettings settings;
+		settings.distanceTolerance = 0.25f / quality;
+		settings.colinearityEpsilon = 1e-30f;
+		settings.angleEpsilon = 0.01f;
+		settings.angleTolerance = 15.0f * 3.14159265f / 180.0f;
+		settings.cuspLimit = 0.0f;
+
+		printf("quality %g:\n", quality);
+		for (const Kind &kind : kinds) {
+			printf("  %s:\n", kind.name);
+			print("recursive", measure(
+				DefaultCurveFlattener(2 * quality, 6), kind.curves, runs));
+			print("antigrain", measure(
+				AntiGrainFlattener(settings, 6), kind.curves, runs));
+			print("wang", measure(
+				WangCurveFlattener(2 * quality, 6), kind.curves, runs));
+		}
+	}
+
+	return 0;
+}
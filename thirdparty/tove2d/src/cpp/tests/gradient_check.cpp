@@ -0,0 +1,209 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// checks that MeshPaint's batched gradient evaluation (SSE2 where the
+// build has it) writes the same bytes as its per-vertex scalar functions,
+// on the inputs where the two could part ways: NaN and infinite positions,
+// gradient parameters far outside [0, 1], a radial gradient evaluated at
+// its focus, and vertex counts that are not a multiple of 4. then times
+// both ways over a large vertex buffer.
+//
+// built by the SConstruct here; ./bin/gradient_check [vertices=1048576] [runs=20]
+
+#include "../graphics.h"
+#include "../mesh/paint.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace tove;
+
+// x, y and 4 color bytes, the layout of a ColorMesh vertex.
+static const int stride = 12;
+
+static NSVGpaint parseFill(const GraphicsRef &graphics, int index) {
+	return graphics->getPath(index)->getNSVG()->fill;
+}
+
+static GraphicsRef makeGradients() {
+	const char *svg =
+		"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">"
+		"<defs>"
+		"<linearGradient id=\"l\" x1=\"10\" y1=\"20\" x2=\"90\" y2=\"70\" gradientUnits=\"userSpaceOnUse\">"
+		"<stop offset=\"0\" stop-color=\"#f00\"/><stop offset=\"0.3\" stop-color=\"#0f0\" stop-opacity=\"0.5\"/>"
+		"<stop offset=\"1\" stop-color=\"#00f\"/></linearGradient>"
+		"<radialGradient id=\"r\" cx=\"50\" cy=\"50\" r=\"40\" gradientUnits=\"userSpaceOnUse\">"
+		"<stop offset=\"0\" stop-color=\"#ff0\"/><stop offset=\"1\" stop-color=\"#0ff\"/></radialGradient>"
+		"<radialGradient id=\"f\" cx=\"50\" cy=\"50\" r=\"40\" fx=\"70\" fy=\"40\" gradientUnits=\"userSpaceOnUse\">"
+		"<stop offset=\"0\" stop-color=\"#fff\"/><stop offset=\"1\" stop-color=\"#000\"/></radialGradient>"
+		"</defs>"
+		"<rect fill=\"url(#l)\" width=\"100\" height=\"100\"/>"
+		"<rect fill=\"url(#r)\" width=\"100\" height=\"100\"/>"
+		"<rect fill=\"url(#f)\" width=\"100\" height=\"100\"/>"
+		"</svg>";
+	return Graphics::createFromSVG(svg, "px", 96.0f);
+}
+
+static void setXY(std::vector<uint8_t> &buffer, int i, float x, float y) {
+	std::memcpy(&buffer[i * stride], &x, sizeof(float));
+	std::memcpy(&buffer[i * stride + 4], &y, sizeof(float));
+}
+
+// edge cases first, then random points, some far outside the gradient.
+static std::vector<uint8_t> makeVertices(int n, std::mt19937 &rng) {
+	const float inf = std::numeric_limits<float>::infinity();
+	const float nan = std::numeric_limits<float>::quiet_NaN();
+	const float special[][2] = {
+		{nan, 0}, {0, nan}, {nan, nan}, {inf, 0}, {-inf, 0}, {0, inf},
+		{0, -inf}, {inf, -inf}, {50, 50}, {70, 40}, {1e30f, -1e30f},
+		{-1e6f, 1e6f}, {0, 0}, {100, 100}, {-100, 300}, {5e-39f, -5e-39f}};
+	const int numSpecial = sizeof(special) / sizeof(special[0]);
+
+	std::uniform_real_distribution<float> inside(0, 100);
+	std::uniform_real_distribution<float> outside(-1000, 1000);
+
+	std::vector<uint8_t> buffer(size_t(n) * stride, 0xcd);
+	for (int i = 0; i < n; i++) {
+		if (i < numSpecial) {
+			setXY(buffer, i, special[i][0], special[i][1]);
+		} else if (i % 3 == 0) {
+			setXY(buffer, i, outside(rng), outside(rng));
+		} else {
+			setXY(buffer, i, inside(rng), inside(rng));
+		}
+	}
+	return buffer;
+}
+
+static int evaluate(const MeshPaint &paint, bool radial, float x, float y) {
+	return radial ?
+		paint.getRadialGradientColor(x, y) :
+		paint.getLinearGradientColor(x, y);
+}
+
+// vertices whose batched color differs from the scalar one.
+static int compare(const MeshPaint &paint, bool radial, std::vector<uint8_t> buffer, int n) {
+	Vertices vertices(buffer.data(), stride);
+	if (radial) {
+		paint.getRadialGradientColors(vertices, n);
+	} else {
+		paint.getLinearGradientColors(vertices, n);
+	}
+
+	int mismatches = 0;
+	for (int i = 0; i < n; i++) {
+		float x, y;
+		std::memcpy(&x, &buffer[i * stride], sizeof(float));
+		std::memcpy(&y, &buffer[i * stride + 4], sizeof(float));
+		const int color = evaluate(paint, radial, x, y);
+		uint8_t expected[4];
+		for (int k = 0; k < 4; k++) {
+			expected[k] = (color >> (8 * k)) & 0xff;
+		}
+		if (std::memcmp(&buffer[i * stride + 8], expected, 4) != 0) {
+			mismatches++;
+		}
+	}
+	return mismatches;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point t0) {
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+	const int numVertices = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	const int runs = argc > 2 ? atoi(argv[2]) : 20;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	printf("batched path: sse2\n");
+#else
+	printf("batched path: scalar\n");
+#endif
+
+	const GraphicsRef graphics = makeGradients();
+	struct Case {
+		const char *name;
+		int path;
+		bool radial;
+	} cases[] = {
+		{"linear", 0, false},
+		{"radial", 1, true},
+		{"radial, focus off center", 2, true}};
+
+	const float scales[] = {1.0f, 0.37f, 3.0f};
+	const int counts[] = {0, 1, 2, 3, 4, 5, 6, 7, 9, 15, 17, 1003};
+
+	std::mt19937 rng(1);
+	long checked = 0;
+	int mismatches = 0;
+	for (const Case &c : cases) {
+		for (float scale : scales) {
+			MeshPaint paint;
+			paint.initialize(parseFill(graphics, c.path), 1.0f, scale);
+			for (int n : counts) {
+				const std::vector<uint8_t> buffer = makeVertices(n, rng);
+				const int bad = compare(paint, c.radial, buffer, n);
+				if (bad > 0) {
+					printf("FAIL: %s, scale %g, %d vertices: %d differ\n",
+						c.name, scale, n, bad);
+				}
+				mismatches += bad;
+				checked += n;
+			}
+		}
+	}
+	printf("%ld vertices checked, %d differ\n", checked, mismatches);
+
+	std::vector<uint8_t> buffer = makeVertices(numVertices, rng);
+	for (const Case &c : cases) {
+		if (c.path == 2) {
+			continue; // same code as the centered radial gradient.
+		}
+		MeshPaint paint;
+		paint.initialize(parseFill(graphics, c.path), 1.0f, 1.0f);
+
+		auto t0 = std::chrono::steady_clock::now();
+		for (int r = 0; r < runs; r++) {
+			Vertices vertex(buffer.data(), stride);
+			for (int i = 0; i < numVertices; i++) {
+				const int color = evaluate(paint, c.radial, vertex->x, vertex->y);
+				std::memcpy(vertex.attr(), &color, 4);
+				vertex++;
+			}
+		}
+		const double scalar = millisecondsSince(t0);
+
+		t0 = std::chrono::steady_clock::now();
+		for (int r = 0; r < runs; r++) {
+			Vertices vertices(buffer.data(), stride);
+			if (c.radial) {
+				paint.getRadialGradientColors(vertices, numVertices);
+			} else {
+				paint.getLinearGradientColors(vertices, numVertices);
+			}
+		}
+		const double batched = millisecondsSince(t0);
+
+		printf("%s, %d x %d vertices: per vertex %.1f ms, batched %.1f ms (%.2fx)\n",
+			c.name, runs, numVertices, scalar, batched, scalar / batched);
+	}
+
+	return mismatches == 0 ? 0 : 1;
+}
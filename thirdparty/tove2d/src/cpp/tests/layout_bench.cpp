@@ -0,0 +1,193 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// throughput of the per-vertex passes over a 1M-vertex ColorMesh in the
+// interleaved and the split vertex layout: painting a solid color and a
+// gradient, computing bounds, and the conversion copy_mesh does into
+// Godot's packed arrays. the last one repeats the loops of the module's
+// copy_mesh_vertices and copy_mesh_colors (utils.cpp), with Vector3 and
+// Color stood in by structs of the same layout, since the engine is not
+// linked here.
+//
+// built by the SConstruct here; ./bin/layout_bench [vertices=1048576] [runs=20]
+
+#include "../graphics.h"
+#include "../mesh/mesh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace tove;
+
+namespace godot {
+
+struct Vector3 {
+	float x, y, z;
+};
+
+struct Color {
+	float r, g, b, a;
+};
+
+} // namespace godot
+
+using godot::Vector3;
+
+struct SRGBToLinearTable {
+	float values[256];
+
+	SRGBToLinearTable() {
+		for (int i = 0; i < 256; i++) {
+			const float c = i / 255.0f;
+			values[i] = c < 0.04045f ? c * (1.0f / 12.92f) :
+				std::pow((c + 0.055f) * (1.0f / 1.055f), 2.4f);
+		}
+	}
+};
+
+static void convert(const MeshRef &mesh, Vector3 *r_vertices, godot::Color *r_colors) {
+	static const SRGBToLinearTable srgb_to_linear;
+	const float *lut = srgb_to_linear.values;
+	const int n = mesh->getVertexCount();
+
+	if (mesh->getLayout() == VERTEX_LAYOUT_SPLIT) {
+		const vec2 *p = mesh->getPositionData();
+		for (int i = 0; i < n; i++) {
+			r_vertices[i] = Vector3{p[i].x * 0.001f, p[i].y * -0.001f, 0.0f};
+		}
+		const uint8_t *c = mesh->getAttributeData();
+		for (int i = 0; i < n; i++) {
+			r_colors[i] = godot::Color{lut[c[4 * i + 0]], lut[c[4 * i + 1]], lut[c[4 * i + 2]], c[4 * i + 3] / 255.0f};
+		}
+	} else {
+		const int position_stride = mesh->getPositionStride();
+		const uint8_t *position_data = (const uint8_t *)mesh->getPositionData();
+		for (int i = 0; i < n; i++) {
+			const float *p = (const float *)(position_data + i * position_stride);
+			r_vertices[i] = Vector3{p[0] * 0.001f, p[1] * -0.001f, 0.0f};
+		}
+		const int color_stride = mesh->getAttributeStride();
+		const uint8_t *color_data = mesh->getAttributeData();
+		for (int i = 0; i < n; i++) {
+			const uint8_t *c = color_data + i * color_stride;
+			r_colors[i] = godot::Color{lut[c[0]], lut[c[1]], lut[c[2]], c[3] / 255.0f};
+		}
+	}
+}
+
+static void bounds(const MeshRef &mesh, float *r_bounds) {
+	const int n = mesh->getVertexCount();
+	const int stride = mesh->getPositionStride();
+	const uint8_t *data = (const uint8_t *)mesh->getPositionData();
+	float x0 = INFINITY, y0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY;
+	for (int i = 0; i < n; i++) {
+		const float *p = (const float *)(data + i * stride);
+		x0 = std::min(x0, p[0]);
+		y0 = std::min(y0, p[1]);
+		x1 = std::max(x1, p[0]);
+		y1 = std::max(y1, p[1]);
+	}
+	r_bounds[0] = x0;
+	r_bounds[1] = y0;
+	r_bounds[2] = x1;
+	r_bounds[3] = y1;
+}
+
+static MeshRef makeMesh(VertexLayout layout, int n) {
+	MeshRef mesh = tove_make_shared<ColorMesh>(layout);
+	Vertices v = mesh->vertices(0, n);
+	for (int i = 0; i < n; i++) {
+		v->x = float(i % 1024);
+		v->y = float(i / 1024);
+		v++;
+	}
+	return mesh;
+}
+
+// the fastest of runs passes; the passes are short enough that the mean
+// mostly measures whatever else the machine is doing.
+template<typename F>
+static double time(int runs, F f) {
+	double best = INFINITY;
+	for (int r = 0; r < runs; r++) {
+		const auto t0 = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - t0).count());
+	}
+	return best;
+}
+
+int main(int argc, char **argv) {
+	const int n = argc > 1 ? atoi(argv[1]) : 1 << 20;
+	const int runs = argc > 2 ? atoi(argv[2]) : 20;
+
+	const GraphicsRef graphics = Graphics::createFromSVG(
+		"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1024\" height=\"1024\">"
+		"<defs><linearGradient id=\"l\" x1=\"0\" y1=\"0\" x2=\"1024\" y2=\"1024\" gradientUnits=\"userSpaceOnUse\">"
+		"<stop offset=\"0\" stop-color=\"#f00\"/><stop offset=\"1\" stop-color=\"#00f\"/></linearGradient></defs>"
+		"<rect fill=\"#3c8\" width=\"1024\" height=\"1024\"/>"
+		"<rect fill=\"url(#l)\" width=\"1024\" height=\"1024\"/>"
+		"</svg>", "px", 96.0f);
+	const PathRef solid = graphics->getPath(0);
+	const PathRef gradient = graphics->getPath(1);
+
+	std::vector<Vector3> godotVertices(n);
+	std::vector<godot::Color> godotColors(n);
+
+	const VertexLayout layouts[] = {VERTEX_LAYOUT_INTERLEAVED, VERTEX_LAYOUT_SPLIT};
+	const char *layoutNames[] = {"interleaved", "split"};
+	std::vector<uint8_t> results[2];
+
+	printf("%d vertices, best of %d, ms per pass (million vertices per second)\n", n, runs);
+	for (int k = 0; k < 2; k++) {
+		MeshRef mesh = makeMesh(layouts[k], n);
+		const double solidMs = time(runs, [&]() {
+			mesh->setFillColor(solid, 0, n);
+			mesh->clearPaintRanges();
+		});
+		const double gradientMs = time(runs, [&]() {
+			mesh->setFillColor(gradient, 0, n);
+			mesh->clearPaintRanges();
+		});
+		float box[4];
+		const double boundsMs = time(runs, [&]() {
+			bounds(mesh, box);
+		});
+		const double convertMs = time(runs, [&]() {
+			convert(mesh, godotVertices.data(), godotColors.data());
+		});
+
+		results[k].resize(size_t(n) * 12);
+		mesh->copyVertexData(results[k].data(), results[k].size());
+
+		printf("  %-11s solid %6.2f (%5.0f)  gradient %6.2f (%4.0f)  bounds %6.2f (%5.0f)  copy_mesh %6.2f (%4.0f)\n",
+			layoutNames[k],
+			solidMs, n / solidMs / 1000.0,
+			gradientMs, n / gradientMs / 1000.0,
+			boundsMs, n / boundsMs / 1000.0,
+			convertMs, n / convertMs / 1000.0);
+		if (box[2] != 1023.0f) {
+			printf("bad bounds\n");
+		}
+	}
+
+	if (results[0] != results[1]) {
+		printf("FAIL: the layouts hold different vertex data\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// stress check for pooled nsvg::ParseContexts: parses many generated svgs
+// (some far larger than the retain limit) on several threads through a small
+// pool, the way the module's load_svg_graphics does, and checks that
+//
+// - every result equals a parse of the same svg with a fresh context,
+// - the heap the idle pooled contexts actually hold stays within the pool's
+//   retain limits, while the same run without a limit does not, so the
+//   measurement is shown to catch retention.
+//
+// built by the SConstruct here; ./bin/parse_stress [svgs=1000] [threads=8]
+
+#include "../graphics.h"
+#include "../nsvg.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace tove;
+
+static const size_t poolSize = 4;
+static const size_t retainLimit = 256 * 1024;
+
+class ContextPool {
+	std::mutex mutex;
+	std::vector<nsvg::ParseContext*> idle;
+	const size_t limit;
+
+public:
+	ContextPool(size_t limit) : limit(limit) {
+	}
+
+	~ContextPool() {
+		clear();
+	}
+
+	nsvg::ParseContext *acquire() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!idle.empty()) {
+				nsvg::ParseContext *context = idle.back();
+				idle.pop_back();
+				return context;
+			}
+		}
+		return new nsvg::ParseContext(limit);
+	}
+
+	void release(nsvg::ParseContext *context) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (idle.size() < poolSize) {
+				idle.push_back(context);
+				return;
+			}
+		}
+		delete context;
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		for (nsvg::ParseContext *context : idle) {
+			delete context;
+		}
+		idle.clear();
+	}
+};
+
+// every 50th svg has thousands of paths and one path with tens of
+// thousands of curves, whose points push a parser well past the retain
+// limit. every 7th fills with gradients.
+static std::string makeSVG(int seed) {
+	const bool large = seed % 50 == 0;
+	const int paths = large ? 4000 : 10 + seed % 90;
+	std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"512\" height=\"512\">";
+	if (large) {
+		svg += "<path fill=\"#808080\" d=\"M0 0";
+		char curve[64];
+		for (int i = 0; i < 20000; i++) {
+			snprintf(curve, sizeof(curve), " C%d %d %d %d %d %d",
+				i % 500, (i * 3) % 500, (i * 5) % 500, (i * 7) % 500,
+				(i * 11) % 500, (i * 13) % 500);
+			svg += curve;
+		}
+		svg += " Z\"/>";
+	}
+	const bool gradients = seed % 7 == 0;
+	if (gradients) {
+		svg += "<defs><linearGradient id=\"l\" x1=\"0\" y1=\"0\" x2=\"1\" y2=\"1\">"
+			"<stop offset=\"0\" stop-color=\"#f00\"/><stop offset=\"1\" stop-color=\"#00f\"/>"
+			"</linearGradient><radialGradient id=\"r\" cx=\"0.5\" cy=\"0.5\" r=\"0.5\">"
+			"<stop offset=\"0\" stop-color=\"#0f0\"/><stop offset=\"0.5\" stop-color=\"#ff0\"/>"
+			"<stop offset=\"1\" stop-color=\"#000\"/></radialGradient></defs>";
+	}
+	char buf[256];
+	char fill[16];
+	for (int i = 0; i < paths; i++) {
+		const int x = (seed * 31 + i * 17) % 500;
+		const int y = (seed * 13 + i * 7) % 500;
+		if (gradients) {
+			snprintf(fill, sizeof(fill), "url(#%c)", i % 2 ? 'l' : 'r');
+		} else {
+			snprintf(fill, sizeof(fill), "#%06x", (seed * 2654435761u + i) & 0xffffff);
+		}
+		snprintf(buf, sizeof(buf),
+			"<path fill=\"%s\" stroke=\"#000\" stroke-width=\"%d\" "
+			"d=\"M%d %d C%d %d %d %d %d %d Q%d %d %d %d Z\"/>",
+			fill, 1 + i % 3,
+			x, y, x + 20, y - 10, x + 40, y + 30, x + 60, y,
+			x + 30, y + 50, x, y + 10);
+		svg += buf;
+	}
+	svg += "</svg>";
+	return svg;
+}
+
+static bool samePaint(const NSVGpaint &a, const NSVGpaint &b) {
+	if (a.type != b.type) {
+		return false;
+	}
+	switch (a.type) {
+		case NSVG_PAINT_COLOR:
+			return a.color == b.color;
+		case NSVG_PAINT_LINEAR_GRADIENT:
+		case NSVG_PAINT_RADIAL_GRADIENT: {
+			const NSVGgradient *ga = a.gradient;
+			const NSVGgradient *gb = b.gradient;
+			if (ga->nstops != gb->nstops || ga->spread != gb->spread ||
+				ga->fx != gb->fx || ga->fy != gb->fy ||
+				std::memcmp(ga->xform, gb->xform, sizeof(ga->xform)) != 0) {
+				return false;
+			}
+			for (int i = 0; i < ga->nstops; i++) {
+				if (ga->stops[i].color != gb->stops[i].color ||
+					ga->stops[i].offset != gb->stops[i].offset) {
+					return false;
+				}
+			}
+			return true;
+		}
+		default:
+			return true;
+	}
+}
+
+static bool sameGraphics(const GraphicsRef &a, const GraphicsRef &b) {
+	if (a->getNumPaths() != b->getNumPaths()) {
+		return false;
+	}
+	for (int i = 0; i < a->getNumPaths(); i++) {
+		const PathRef pa = a->getPath(i);
+		const PathRef pb = b->getPath(i);
+		const NSVGshape *sa = pa->getNSVG();
+		const NSVGshape *sb = pb->getNSVG();
+		if (!samePaint(sa->fill, sb->fill) || !samePaint(sa->stroke, sb->stroke) ||
+			sa->strokeWidth != sb->strokeWidth || sa->fillRule != sb->fillRule ||
+			sa->opacity != sb->opacity) {
+			return false;
+		}
+		if (pa->getNumSubpaths() != pb->getNumSubpaths()) {
+			return false;
+		}
+		for (int j = 0; j < pa->getNumSubpaths(); j++) {
+			const NSVGpath &qa = pa->getSubpath(j)->nsvg;
+			const NSVGpath &qb = pb->getSubpath(j)->nsvg;
+			if (qa.npts != qb.npts || qa.closed != qb.closed ||
+				std::memcmp(qa.pts, qb.pts, sizeof(float) * 2 * qa.npts) != 0) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// bytes the allocator has handed out and not yet got back, over all
+// arenas; 0 where that cannot be asked for.
+static size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	const struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+static size_t peakResidentBytes() {
+#if defined(__linux__)
+	size_t kb = 0;
+	FILE *f = fopen("/proc/self/status", "r");
+	if (f) {
+		char line[256];
+		while (fgets(line, sizeof(line), f)) {
+			if (std::strncmp(line, "VmHWM:", 6) == 0) {
+				kb = strtoul(line + 6, nullptr, 10);
+			}
+		}
+		fclose(f);
+	}
+	return kb * 1024;
+#else
+	return 0;
+#endif
+}
+
+struct RunResult {
+	long paths;
+	int mismatches;
+	size_t retained; // heap held by the idle pool after the run
+};
+
+static RunResult run(int numSVGs, int numThreads, size_t limit) {
+	ContextPool pool(limit);
+	std::atomic<int> next(0);
+	std::atomic<long> paths(0);
+	std::atomic<int> mismatches(0);
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < numThreads; t++) {
+		threads.emplace_back([&]() {
+			int i;
+			while ((i = next.fetch_add(1)) < numSVGs) {
+				const std::string svg = makeSVG(i);
+
+				nsvg::ParseContext *context = pool.acquire();
+				const GraphicsRef pooled = Graphics::createFromSVG(
+					svg.c_str(), "px", 96.0f, context);
+				pool.release(context);
+
+				nsvg::ParseContext fresh(limit);
+				const GraphicsRef reference = Graphics::createFromSVG(
+					svg.c_str(), "px", 96.0f, &fresh);
+
+				paths += pooled->getNumPaths();
+				if (!sameGraphics(pooled, reference)) {
+					mismatches++;
+				}
+			}
+		});
+	}
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+
+	RunResult result;
+	result.paths = paths.load();
+	result.mismatches = mismatches.load();
+	const size_t withPool = heapInUse();
+	pool.clear();
+	const size_t withoutPool = heapInUse();
+	result.retained = withPool > withoutPool ? withPool - withoutPool : 0;
+	return result;
+}
+
+int main(int argc, char **argv) {
+	const int numSVGs = argc > 1 ? atoi(argv[1]) : 1000;
+	const int numThreads = argc > 2 ? atoi(argv[2]) : 8;
+
+	const RunResult bounded = run(numSVGs, numThreads, retainLimit);
+	const size_t boundedPeak = peakResidentBytes();
+	const RunResult unbounded = run(numSVGs, numThreads, SIZE_MAX);
+
+	printf("svgs %d, threads %d, paths %ld\n", numSVGs, numThreads, bounded.paths);
+	printf("results differing from a fresh context: %d, %d without limit\n",
+		bounded.mismatches, unbounded.mismatches);
+	printf("heap held by %zu idle contexts: %.1f KiB (limit %.1f KiB), "
+		"%.1f KiB without limit\n", poolSize,
+		bounded.retained / 1024.0, poolSize * retainLimit / 1024.0,
+		unbounded.retained / 1024.0);
+	printf("peak resident: %.1f MB\n", boundedPeak / 1048576.0);
+
+	bool ok = true;
+	if (bounded.mismatches > 0 || unbounded.mismatches > 0) {
+		printf("FAIL: a pooled parse differs from a fresh one\n");
+		ok = false;
+	}
+	if (heapInUse() == 0) {
+		printf("skipped heap checks: allocator statistics unavailable\n");
+	} else {
+		if (bounded.retained > poolSize * retainLimit) {
+			printf("FAIL: the idle pool holds more than its retain limits\n");
+			ok = false;
+		}
+		if (unbounded.retained <= bounded.retained) {
+			printf("FAIL: no retention measured without a limit\n");
+			ok = false;
+		}
+	}
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// stands in for the engine's error macros, so that the checks here build
+// without the engine.
+
+#ifndef __TOVE_TESTS_ERROR_MACROS
+#define __TOVE_TESTS_ERROR_MACROS 1
+
+#include <cstdio>
+#include <cstdlib>
+
+#define CRASH_NOW_MSG(m) { fprintf(stderr, "%s\n", m); abort(); }
+
+#endif // __TOVE_TESTS_ERROR_MACROS
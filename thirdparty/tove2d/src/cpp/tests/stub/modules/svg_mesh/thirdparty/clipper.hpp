@@ -0,0 +1,3 @@
+// common.h includes clipper by its path in the engine tree; this points
+// that path at the module's copy.
+#include "../../../../../../../../clipper.hpp"
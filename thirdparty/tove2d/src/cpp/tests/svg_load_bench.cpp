@@ -0,0 +1,270 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// time and peak memory of loading a multi-megabyte svg file the way the
+// module's load_svg_graphics does it (read the bytes once, terminate them,
+// parse) against the path it replaced (bytes, then a decoded UTF-32 String
+// via parse_utf8, then utf8() back into a CharString that gets parsed).
+// Godot's String is not linked here, so the replaced path decodes into a
+// std::u32string and encodes back with the same per-character work.
+// every variant runs in its own child process, so that its peak resident
+// size can be read from the kernel.
+//
+// built by the SConstruct here; ./bin/svg_load_bench [megabytes=4,16,64] [runs=3]
+
+#include "../graphics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace tove;
+
+// paths with long curve lists and some non-ascii text, about megabytes
+// in size.
+static void writeSVG(const char *filename, int megabytes) {
+	FILE *f = fopen(filename, "wb");
+	fputs("\xef\xbb\xbf<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1000\" height=\"1000\">\n", f);
+	long written = 0;
+	char buf[128];
+	for (int i = 0; written < megabytes * 1048576L; i++) {
+		written += fprintf(f, "<!-- Stra\xc3\x9f" "e \xe6\x9d\xb1\xe4\xba\xac %d -->\n", i);
+		written += fprintf(f, "<path fill=\"#%06x\" d=\"M%d %d", (i * 2654435761u) & 0xffffff, i % 1000, (i * 7) % 1000);
+		for (int j = 0; j < 40; j++) {
+			const int x = (i * 13 + j * 29) % 1000;
+			const int y = (i * 17 + j * 31) % 1000;
+			written += snprintf(buf, sizeof(buf), " C%d %d %d %d %d %d",
+				x, y, (x + 40) % 1000, (y + 10) % 1000, (x + 20) % 1000, (y + 50) % 1000);
+			fputs(buf, f);
+		}
+		written += fprintf(f, " Z\"/>\n");
+	}
+	fputs("</svg>\n", f);
+	fclose(f);
+}
+
+static std::vector<char> readTerminated(const char *filename) {
+	FILE *f = fopen(filename, "rb");
+	fseek(f, 0, SEEK_END);
+	const long len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	std::vector<char> buf(len + 1);
+	const size_t read = fread(buf.data(), 1, len, f);
+	buf[read] = '\0';
+	fclose(f);
+	return buf;
+}
+
+static std::vector<uint8_t> readBytes(const char *filename) {
+	FILE *f = fopen(filename, "rb");
+	fseek(f, 0, SEEK_END);
+	const long len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	std::vector<uint8_t> buf(len);
+	buf.resize(fread(buf.data(), 1, len, f));
+	fclose(f);
+	return buf;
+}
+
+// String::parse_utf8: decodes into one 32-bit char per code point, skipping
+// a BOM.
+static std::u32string decodeUTF8(const uint8_t *s, size_t n) {
+	std::u32string out;
+	out.reserve(n);
+	size_t i = 0;
+	if (n >= 3 && s[0] == 0xef && s[1] == 0xbb && s[2] == 0xbf) {
+		i = 3;
+	}
+	while (i < n) {
+		const uint8_t c = s[i];
+		char32_t cp;
+		int k;
+		if (c < 0x80) {
+			cp = c;
+			k = 0;
+		} else if ((c & 0xe0) == 0xc0) {
+			cp = c & 0x1f;
+			k = 1;
+		} else if ((c & 0xf0) == 0xe0) {
+			cp = c & 0x0f;
+			k = 2;
+		} else {
+			cp = c & 0x07;
+			k = 3;
+		}
+		i++;
+		for (int j = 0; j < k && i < n; j++) {
+			cp = (cp << 6) | (s[i++] & 0x3f);
+		}
+		out.push_back(cp);
+	}
+	return out;
+}
+
+// String::utf8: encodes back into a CharString.
+static std::string encodeUTF8(const std::u32string &s) {
+	size_t size = 0;
+	for (char32_t c : s) {
+		size += c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+	}
+	std::string out;
+	out.resize(size);
+	char *p = &out[0];
+	for (char32_t c : s) {
+		if (c < 0x80) {
+			*p++ = char(c);
+		} else if (c < 0x800) {
+			*p++ = char(0xc0 | (c >> 6));
+			*p++ = char(0x80 | (c & 0x3f));
+		} else if (c < 0x10000) {
+			*p++ = char(0xe0 | (c >> 12));
+			*p++ = char(0x80 | ((c >> 6) & 0x3f));
+			*p++ = char(0x80 | (c & 0x3f));
+		} else {
+			*p++ = char(0xf0 | (c >> 18));
+			*p++ = char(0x80 | ((c >> 12) & 0x3f));
+			*p++ = char(0x80 | ((c >> 6) & 0x3f));
+			*p++ = char(0x80 | (c & 0x3f));
+		}
+	}
+	return out;
+}
+
+struct Sample {
+	double loadMs; // reading and transcoding
+	double totalMs; // including the parse
+	double peakMB;
+	int paths;
+};
+
+static double peakResidentMB() {
+	size_t kb = 0;
+	FILE *f = fopen("/proc/self/status", "r");
+	if (f) {
+		char line[256];
+		while (fgets(line, sizeof(line), f)) {
+			if (std::strncmp(line, "VmHWM:", 6) == 0) {
+				kb = strtoul(line + 6, nullptr, 10);
+			}
+		}
+		fclose(f);
+	}
+	return kb / 1024.0;
+}
+
+static double millisecondsSince(std::chrono::steady_clock::time_point t0) {
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - t0).count();
+}
+
+static Sample load(const char *filename, bool direct) {
+	Sample sample;
+	const auto t0 = std::chrono::steady_clock::now();
+	GraphicsRef graphics;
+	if (direct) {
+		std::vector<char> buf = readTerminated(filename);
+		sample.loadMs = millisecondsSince(t0);
+		graphics = Graphics::createFromSVG(buf.data(), "px", 96.0f);
+	} else {
+		// all three copies are alive during the parse, as they were in
+		// VGPath::import_svg.
+		std::vector<uint8_t> buf = readBytes(filename);
+		const std::u32string str = decodeUTF8(buf.data(), buf.size());
+		const std::string utf8 = encodeUTF8(str);
+		sample.loadMs = millisecondsSince(t0);
+		graphics = Graphics::createFromSVG(utf8.c_str(), "px", 96.0f);
+	}
+	sample.totalMs = millisecondsSince(t0);
+	sample.paths = graphics->getNumPaths();
+	sample.peakMB = peakResidentMB();
+	return sample;
+}
+
+// runs load() in a fresh child process.
+static Sample measure(const char *filename, bool direct) {
+	Sample sample = {0, 0, 0, 0};
+#if defined(__linux__)
+	int fds[2];
+	if (pipe(fds) != 0) {
+		return sample;
+	}
+	const pid_t pid = fork();
+	if (pid == 0) {
+		close(fds[0]);
+		const double baseline = peakResidentMB();
+		Sample s = load(filename, direct);
+		s.peakMB -= baseline;
+		if (write(fds[1], &s, sizeof(s)) != sizeof(s)) {
+			_exit(1);
+		}
+		_exit(0);
+	}
+	close(fds[1]);
+	if (read(fds[0], &sample, sizeof(sample)) != sizeof(sample)) {
+		printf("child failed\n");
+	}
+	close(fds[0]);
+	waitpid(pid, nullptr, 0);
+#else
+	sample = load(filename, direct);
+#endif
+	return sample;
+}
+
+int main(int argc, char **argv) {
+	std::vector<int> sizes;
+	if (argc > 1) {
+		sizes.push_back(atoi(argv[1]));
+	} else {
+		sizes = {4, 16, 64};
+	}
+	const int runs = argc > 2 ? atoi(argv[2]) : 3;
+
+	const char *filename = "svg_load_bench.svg";
+	bool ok = true;
+	for (int megabytes : sizes) {
+		writeSVG(filename, megabytes);
+
+		Sample best[2];
+		for (int k = 0; k < 2; k++) {
+			for (int r = 0; r < runs; r++) {
+				const Sample s = measure(filename, k == 1);
+				if (r == 0 || s.totalMs < best[k].totalMs) {
+					const double peak = r == 0 ? s.peakMB : best[k].peakMB;
+					best[k] = s;
+					best[k].peakMB = std::max(peak, s.peakMB);
+				}
+			}
+		}
+
+		printf("%d MB, %d paths:\n", megabytes, best[1].paths);
+		const char *names[] = {"via String", "direct"};
+		for (int k = 0; k < 2; k++) {
+			printf("  %-10s read + transcode %7.1f ms, with parse %8.1f ms, peak %7.1f MB\n",
+				names[k], best[k].loadMs, best[k].totalMs, best[k].peakMB);
+		}
+		if (best[0].paths != best[1].paths) {
+			printf("FAIL: the two paths parse differently\n");
+			ok = false;
+		}
+	}
+	remove(filename);
+	return ok ? 0 : 1;
+}
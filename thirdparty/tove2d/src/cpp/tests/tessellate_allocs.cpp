@@ -0,0 +1,138 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// counts the heap allocations AdaptiveTesselator::pathToMesh makes once it
+// has warmed up, i.e. what every re-tessellation of an animated path costs,
+// for fills, strokes and clip paths, with both triangulations. the
+// meshes are recycled between runs, so what is left is the flattening,
+// clipping and triangulation work itself.
+//
+// built by the SConstruct here; ./bin/tessellate_allocs [runs=200]
+
+#include "../graphics.h"
+#include "../mesh/meshifier.h"
+#include "../mesh/mesh.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace tove;
+
+static std::atomic<long> allocations(0);
+
+void *operator new(size_t size) {
+	allocations++;
+	void *p = malloc(size ? size : 1);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+	free(p);
+}
+
+static const char *svg =
+	"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"400\" height=\"400\">"
+	"<defs><clipPath id=\"c\"><circle cx=\"100\" cy=\"300\" r=\"60\"/></clipPath></defs>"
+	// fill only, self-intersecting.
+	"<path fill=\"#f80\" fill-rule=\"evenodd\" d=\"M100 10 L160 190 L10 80 L190 80 L40 190 Z\"/>"
+	// fill and stroke, two curved subpaths.
+	"<path fill=\"#08f\" stroke=\"#000\" stroke-width=\"4\" stroke-linejoin=\"round\" "
+	"d=\"M220 20 C300 0 380 60 360 120 C340 180 260 200 230 150 Z "
+	"M260 80 C280 60 320 70 310 100 C300 130 270 120 260 80 Z\"/>"
+	// open stroke only.
+	"<path fill=\"none\" stroke=\"#000\" stroke-width=\"3\" stroke-linecap=\"round\" "
+	"d=\"M20 220 C80 200 120 260 180 230 S260 200 300 240\"/>"
+	// clipped fill.
+	"<ellipse clip-path=\"url(#c)\" fill=\"#0a0\" cx=\"120\" cy=\"310\" rx=\"80\" ry=\"40\"/>"
+	"</svg>";
+
+static const char *pathNames[] = {
+	"fill", "fill + stroke", "open stroke", "clipped fill"};
+
+static double millisecondsSince(std::chrono::steady_clock::time_point t0) {
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv) {
+	const int runs = argc > 1 ? atoi(argv[1]) : 200;
+
+	const GraphicsRef graphics = Graphics::createFromSVG(svg, "px", 96.0f);
+
+	const ToveTriangulation triangulations[] = {
+		TOVE_TRIANGULATION_EAR_CLIPPING, TOVE_TRIANGULATION_MONOTONE};
+	const char *triangulationNames[] = {"ear clipping", "monotone"};
+
+	for (int k = 0; k < 2; k++) {
+		AdaptiveTesselator tesselator(
+			new AdaptiveFlattener<DefaultCurveFlattener>(
+				DefaultCurveFlattener(200.0f, 6)),
+			triangulations[k]);
+
+		printf("%s:\n", triangulationNames[k]);
+		for (int i = 0; i < graphics->getNumPaths(); i++) {
+			const PathRef path = graphics->getPath(i);
+			MeshRef fill = tove_make_shared<ColorMesh>();
+			MeshRef line = tove_make_shared<ColorMesh>();
+
+			long counted = 0;
+			int vertices = 0;
+			auto t0 = std::chrono::steady_clock::now();
+			// the first run sizes the meshes and the scratch arena.
+			for (int r = -1; r < runs; r++) {
+				if (r == 0) {
+					t0 = std::chrono::steady_clock::now();
+				}
+				fill->recycle();
+				line->recycle();
+				int fillIndex = 0;
+				int lineIndex = 0;
+				tesselator.beginTesselate(graphics.get(), 1.0f);
+				const long before = allocations.load();
+				tesselator.pathToMesh(UPDATE_MESH_EVERYTHING,
+					path, fill, line, fillIndex, lineIndex);
+				if (r >= 0) {
+					counted += allocations.load() - before;
+				}
+				tesselator.endTesselate();
+				vertices = fill->getVertexCount() + line->getVertexCount();
+			}
+			const double ms = millisecondsSince(t0);
+
+			printf("  %-14s %5d vertices: %7.1f allocations, %6.1f us per tessellation\n",
+				pathNames[i], vertices, counted / double(runs), 1000.0 * ms / runs);
+		}
+	}
+
+	return 0;
+}
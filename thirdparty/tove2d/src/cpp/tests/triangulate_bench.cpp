@@ -0,0 +1,162 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+// times Submesh::addClipperPaths with TOVE_TRIANGULATION_MONOTONE against
+// TOVE_TRIANGULATION_EAR_CLIPPING on wavy outlines of growing size, with and
+// without holes, the way AdaptiveTesselator calls it (inside a scratch arena
+// scope). checks that both cover the outline's area with the expected
+// number of triangles.
+//
+// built by the SConstruct here; ./bin/triangulate_bench [max points=16000]
+
+#include "../graphics.h"
+#include "../mesh/arena.h"
+#include "../mesh/mesh.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace tove;
+
+static const float clipperScale = 65536.0f;
+
+static double area(const ClipperPath &path) {
+	double a = 0;
+	for (size_t i = 0; i < path.size(); i++) {
+		const ClipperPoint &p = path[i];
+		const ClipperPoint &q = path[(i + 1) % path.size()];
+		a += (double(p.X) * q.Y - double(q.X) * p.Y) * 0.5;
+	}
+	return a / (double(clipperScale) * clipperScale);
+}
+
+// a counterclockwise outline of n points with a wavy rim, and holes as
+// clockwise circles of 32 points, as ClipperLib hands them over.
+static ClipperPaths makeShape(int n, int numHoles) {
+	ClipperPaths paths;
+	ClipperPath outline;
+	for (int i = 0; i < n; i++) {
+		const double t = 2 * M_PI * i / n;
+		const double r = 1000 + 40 * std::sin(37 * t) + 15 * std::sin(211 * t);
+		outline.push_back(ClipperPoint(
+			r * std::cos(t) * clipperScale, r * std::sin(t) * clipperScale));
+	}
+	paths.push_back(outline);
+
+	const int grid = int(std::ceil(std::sqrt(double(numHoles))));
+	for (int h = 0; h < numHoles; h++) {
+		const double cx = (h % grid - (grid - 1) * 0.5) * 1200.0 / grid;
+		const double cy = (h / grid - (grid - 1) * 0.5) * 1200.0 / grid;
+		ClipperPath hole;
+		for (int i = 0; i < 32; i++) {
+			const double t = -2 * M_PI * i / 32;
+			hole.push_back(ClipperPoint(
+				(cx + 20 * std::cos(t)) * clipperScale,
+				(cy + 20 * std::sin(t)) * clipperScale));
+		}
+		paths.push_back(hole);
+	}
+	return paths;
+}
+
+struct Result {
+	double milliseconds;
+	int triangles;
+	double area;
+};
+
+// repeats for at least 200 ms, so the slow cases run once.
+static Result run(const ClipperPaths &paths, const PathRef &key,
+	ToveTriangulation triangulation) {
+
+	MeshRef mesh = tove_make_shared<ColorMesh>(VERTEX_LAYOUT_SPLIT);
+	ScratchArena scratch;
+
+	const auto t0 = std::chrono::steady_clock::now();
+	int repeats = 0;
+	double elapsed = 0;
+	while (elapsed < 200.0) {
+		mesh->recycle();
+		{
+			ScratchArena::Scope scope(scratch);
+			mesh->submesh(key, 0)->addClipperPaths(
+				paths, clipperScale, TOVE_HOLES_CW, triangulation);
+		}
+		repeats++;
+		elapsed = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - t0).count();
+	}
+	Result result;
+	result.milliseconds = elapsed / repeats;
+
+	const int indexCount = mesh->getIndexCount();
+	std::vector<int32_t> indices(indexCount);
+	mesh->copyIndexData(indices.data(), indexCount, 0);
+	const vec2 *p = mesh->getPositionData();
+	result.triangles = indexCount / 3;
+	result.area = 0;
+	for (int i = 0; i + 2 < indexCount; i += 3) {
+		const vec2 &a = p[indices[i]];
+		const vec2 &b = p[indices[i + 1]];
+		const vec2 &c = p[indices[i + 2]];
+		result.area += std::abs(
+			(double(b.x) - a.x) * (double(c.y) - a.y) -
+			(double(c.x) - a.x) * (double(b.y) - a.y)) * 0.5;
+	}
+	return result;
+}
+
+int main(int argc, char **argv) {
+	const int maxPoints = argc > 1 ? atoi(argv[1]) : 16000;
+
+	// only serves as the submesh key.
+	const GraphicsRef graphics = Graphics::createFromSVG(
+		"<svg xmlns=\"http://www.w3.org/2000/svg\"><rect width=\"1\" height=\"1\"/></svg>",
+		"px", 96.0f);
+	const PathRef key = graphics->getPath(0);
+
+	bool ok = true;
+	const int holeCounts[] = {0, 16};
+	for (int numHoles : holeCounts) {
+		for (int n = 250; n <= maxPoints; n *= 4) {
+			const ClipperPaths paths = makeShape(n, numHoles);
+			double expectedArea = 0;
+			int points = 0;
+			for (const ClipperPath &path : paths) {
+				expectedArea += area(path);
+				points += path.size();
+			}
+			const int expectedTriangles = points - 2 + 2 * numHoles;
+
+			const Result ec = run(paths, key, TOVE_TRIANGULATION_EAR_CLIPPING);
+			const Result mono = run(paths, key, TOVE_TRIANGULATION_MONOTONE);
+
+			printf("%6d points, %2d holes: ear clipping %9.3f ms, monotone %7.3f ms (%.1fx)\n",
+				points, numHoles, ec.milliseconds, mono.milliseconds,
+				ec.milliseconds / mono.milliseconds);
+
+			for (const Result *r : {&ec, &mono}) {
+				if (r->triangles != expectedTriangles ||
+					std::abs(r->area - expectedArea) > 1e-4 * expectedArea) {
+					printf("FAIL: %s: %d triangles covering %.1f, expected %d covering %.1f\n",
+						r == &ec ? "ear clipping" : "monotone",
+						r->triangles, r->area, expectedTriangles, expectedArea);
+					ok = false;
+				}
+			}
+		}
+	}
+
+	return ok ? 0 : 1;
+}
@@ -17,8 +17,11 @@
 
 BEGIN_TOVE_NAMESPACE
 
+// NaN gives v1, as SSE's min(x, v1) does, so that it never reaches an
+// index computed from the result.
 inline float clamp(float x, float v0, float v1) {
-	return std::max(std::min(x, v1), v0);
+	const float y = x < v1 ? x : v1;
+	return y > v0 ? y : v0;
 }
 
 inline float lerp(float a, float b, float t) {
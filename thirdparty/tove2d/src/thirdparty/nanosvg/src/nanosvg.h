@@ -640,15 +640,10 @@ static void nsvg__curveBounds(float* bounds, float* curve)
 	}
 }
 
-static NSVGparser* nsvg__createParser()
+static int nsvg__initParser(NSVGparser* p)
 {
-	NSVGparser* p;
-	p = (NSVGparser*)malloc(sizeof(NSVGparser));
-	if (p == NULL) goto error;
-	memset(p, 0, sizeof(NSVGparser));
-
 	p->image = (NSVGimage*)malloc(sizeof(NSVGimage));
-	if (p->image == NULL) goto error;
+	if (p->image == NULL) return 0;
 	memset(p->image, 0, sizeof(NSVGimage));
 
 	// Init style
@@ -668,6 +663,18 @@ static NSVGparser* nsvg__createParser()
 	p->attr[0].hasFill = 1;
 	p->attr[0].visible = 1;
 
+	return 1;
+}
+
+static NSVGparser* nsvg__createParser()
+{
+	NSVGparser* p;
+	p = (NSVGparser*)malloc(sizeof(NSVGparser));
+	if (p == NULL) goto error;
+	memset(p, 0, sizeof(NSVGparser));
+
+	if (!nsvg__initParser(p)) goto error;
+
 	return p;
 
 error:
@@ -722,6 +729,23 @@ static void nsvg__resetPath(NSVGparser* p)
 	p->npts = 0;
 }
 
+// Prepares a used parser for the next document, keeping its point buffer.
+static int nsvg__recycleParser(NSVGparser* p)
+{
+	float* pts = p->pts;
+	int cpts = p->cpts;
+
+	nsvg__deletePaths(p->plist);
+	nsvg__deleteGradientData(p->gradients);
+	nsvgDelete(p->image);
+
+	memset(p, 0, sizeof(NSVGparser));
+	p->pts = pts;
+	p->cpts = cpts;
+
+	return nsvg__initParser(p);
+}
+
 static void nsvg__addPoint(NSVGparser* p, float x, float y)
 {
 	if (p->npts+1 > p->cpts) {
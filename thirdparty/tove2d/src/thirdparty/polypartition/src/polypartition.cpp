@@ -27,6 +27,8 @@
 #include <set>
 #include <vector>
 #include <stdexcept>
+#include <new>
+#include <stdlib.h>
 
 using namespace std;
 
@@ -38,6 +40,42 @@ using namespace std;
 #define TPPL_VERTEXTYPE_SPLIT 3
 #define TPPL_VERTEXTYPE_MERGE 4
 
+static thread_local TPPLScratch *activeScratch = NULL;
+
+TPPLScratch *TPPLScratch::GetActive() {
+	return activeScratch;
+}
+
+void TPPLScratch::SetActive(TPPLScratch *scratch) {
+	activeScratch = scratch;
+}
+
+//every block starts with a header telling TPPLFree where it came from, so
+//heap blocks freed while a scratch is active (and vice versa) stay correct.
+union TPPLBlockHeader {
+	bool scratch;
+	max_align_t align;
+};
+
+void *TPPLAllocate(size_t size) {
+	TPPLBlockHeader *header;
+	if(activeScratch) {
+		header = (TPPLBlockHeader*)activeScratch->Allocate(sizeof(TPPLBlockHeader) + size);
+		header->scratch = true;
+	} else {
+		header = (TPPLBlockHeader*)malloc(sizeof(TPPLBlockHeader) + size);
+		if(!header) throw std::bad_alloc();
+		header->scratch = false;
+	}
+	return header + 1;
+}
+
+void TPPLFree(void *p) {
+	if(!p) return;
+	TPPLBlockHeader *header = ((TPPLBlockHeader*)p) - 1;
+	if(!header->scratch) free(header);
+}
+
 ToveTPPLPoly::ToveTPPLPoly() { 
 	hole = false;
 	numpoints = 0;
@@ -45,11 +83,11 @@ ToveTPPLPoly::ToveTPPLPoly() {
 }
 
 ToveTPPLPoly::~ToveTPPLPoly() {
-	if(points) delete [] points;
+	TPPLFree(points);
 }
 
 void ToveTPPLPoly::Clear() {
-	if(points) delete [] points;
+	TPPLFree(points);
 	hole = false;
 	numpoints = 0;
 	points = NULL;
@@ -58,7 +96,7 @@ void ToveTPPLPoly::Clear() {
 void ToveTPPLPoly::Init(long numpoints) {
 	Clear();
 	this->numpoints = numpoints;
-	points = new TPPLPoint[numpoints];
+	points = (TPPLPoint*)TPPLAllocate(numpoints*sizeof(TPPLPoint));
 }
 
 void ToveTPPLPoly::Triangle(TPPLPoint &p1, TPPLPoint &p2, TPPLPoint &p3) {
@@ -73,7 +111,7 @@ ToveTPPLPoly::ToveTPPLPoly(const ToveTPPLPoly &src) : ToveTPPLPoly() {
 	numpoints = src.numpoints;
 
 	if(numpoints > 0) {
-		points = new TPPLPoint[numpoints];
+		points = (TPPLPoint*)TPPLAllocate(numpoints*sizeof(TPPLPoint));
 		memcpy(points, src.points, numpoints*sizeof(TPPLPoint));
 	}
 }
@@ -84,7 +122,7 @@ ToveTPPLPoly& ToveTPPLPoly::operator=(const ToveTPPLPoly &src) {
 	numpoints = src.numpoints;
 	
 	if(numpoints > 0) {
-		points = new TPPLPoint[numpoints];
+		points = (TPPLPoint*)TPPLAllocate(numpoints*sizeof(TPPLPoint));
 		memcpy(points, src.points, numpoints*sizeof(TPPLPoint));
 	}
 	
@@ -392,7 +430,7 @@ int ToveTPPLPartition::Triangulate_EC(ToveTPPLPoly *poly, TPPLPolyList *triangle
 
 	numvertices = poly->GetNumPoints();
 
-	vertices = new PartitionVertex[numvertices];
+	vertices = TPPLNewArray<PartitionVertex>(numvertices);
 	for(i=0;i<numvertices;i++) {
 		vertices[i].isActive = true;
 		vertices[i].p = poly->GetPoint(i);
@@ -421,7 +459,7 @@ int ToveTPPLPartition::Triangulate_EC(ToveTPPLPoly *poly, TPPLPolyList *triangle
 			}
 		}
 		if(!earfound) {
-			delete [] vertices;
+			TPPLDeleteArray(vertices, numvertices);
 			return 0;
 		}
 
@@ -445,7 +483,7 @@ int ToveTPPLPartition::Triangulate_EC(ToveTPPLPoly *poly, TPPLPolyList *triangle
 		}
 	}
 
-	delete [] vertices;
+	TPPLDeleteArray(vertices, numvertices);
 
 	return 1;
 }
@@ -1082,7 +1120,7 @@ int ToveTPPLPartition::MonotonePartition(TPPLPolyList *inpolys, TPPLPolyList *mo
 	}
 
 	maxnumvertices = numvertices*3;
-	vertices = new MonotoneVertex[maxnumvertices];
+	vertices = TPPLNewArray<MonotoneVertex>(maxnumvertices);
 	newnumvertices = numvertices;
 
 	polystartindex = 0;
@@ -1100,12 +1138,12 @@ int ToveTPPLPartition::MonotonePartition(TPPLPolyList *inpolys, TPPLPolyList *mo
 	}
 
 	//construct the priority queue
-	long *priority = new long [numvertices];
+	long *priority = TPPLNewArray<long>(numvertices);
 	for(i=0;i<numvertices;i++) priority[i] = i;
 	std::sort(priority,&(priority[numvertices]),VertexSorter(vertices));
 
 	//determine vertex types
-	char *vertextypes = new char[maxnumvertices];
+	char *vertextypes = TPPLNewArray<char>(maxnumvertices);
 	for(i=0;i<numvertices;i++) {
 		v = &(vertices[i]);
 		vprev = &(vertices[v->previous]);
@@ -1130,17 +1168,17 @@ int ToveTPPLPartition::MonotonePartition(TPPLPolyList *inpolys, TPPLPolyList *mo
 	}
 
 	//helpers
-	long *helpers = new long[maxnumvertices];
+	long *helpers = TPPLNewArray<long>(maxnumvertices);
 
 	//binary search tree that holds edges intersecting the scanline
 	//note that while set doesn't actually have to be implemented as a tree
 	//complexity requirements for operations are the same as for the balanced binary search tree
-	set<ScanLineEdge> edgeTree;
+	ScanLineEdgeSet edgeTree;
 	//store iterators to the edge tree elements
 	//this makes deleting existing edges much faster
-	set<ScanLineEdge>::iterator *edgeTreeIterators,edgeIter;
-	edgeTreeIterators = new set<ScanLineEdge>::iterator[maxnumvertices];
-	pair<set<ScanLineEdge>::iterator,bool> edgeTreeRet;
+	ScanLineEdgeSet::iterator *edgeTreeIterators,edgeIter;
+	edgeTreeIterators = TPPLNewArray<ScanLineEdgeSet::iterator>(maxnumvertices);
+	pair<ScanLineEdgeSet::iterator,bool> edgeTreeRet;
 	for(i = 0; i<numvertices; i++) edgeTreeIterators[i] = edgeTree.end();
 
 	//for each vertex
@@ -1287,7 +1325,7 @@ int ToveTPPLPartition::MonotonePartition(TPPLPolyList *inpolys, TPPLPolyList *mo
 		if(error) break;
 	}
 
-	char *used = new char[newnumvertices];
+	char *used = TPPLNewArray<char>(newnumvertices);
 	memset(used,0,newnumvertices*sizeof(char));
 
 	if(!error) {
@@ -1321,12 +1359,12 @@ int ToveTPPLPartition::MonotonePartition(TPPLPolyList *inpolys, TPPLPolyList *mo
 	}
 
 	//cleanup
-	delete [] vertices;
-	delete [] priority;
-	delete [] vertextypes;
-	delete [] edgeTreeIterators;
-	delete [] helpers;
-	delete [] used;
+	TPPLDeleteArray(vertices, maxnumvertices);
+	TPPLDeleteArray(priority, numvertices);
+	TPPLDeleteArray(vertextypes, maxnumvertices);
+	TPPLDeleteArray(edgeTreeIterators, maxnumvertices);
+	TPPLDeleteArray(helpers, maxnumvertices);
+	TPPLDeleteArray(used, newnumvertices);
 
 	if(error) {
 		return 0;
@@ -1337,8 +1375,8 @@ int ToveTPPLPartition::MonotonePartition(TPPLPolyList *inpolys, TPPLPolyList *mo
 
 //adds a diagonal to the doubly-connected list of vertices
 void ToveTPPLPartition::AddDiagonal(MonotoneVertex *vertices, long *numvertices, long index1, long index2, 
-								char *vertextypes, set<ScanLineEdge>::iterator *edgeTreeIterators, 
-								set<ScanLineEdge> *edgeTree, long *helpers) 
+								char *vertextypes, ScanLineEdgeSet::iterator *edgeTreeIterators, 
+								ScanLineEdgeSet *edgeTree, long *helpers) 
 {
 	long newindex1,newindex2;
 
@@ -1458,8 +1496,8 @@ int ToveTPPLPartition::TriangulateMonotone(ToveTPPLPoly *inPoly, TPPLPolyList *t
 		i = i2;
 	}
 
-	char *vertextypes = new char[numpoints];
-	long *priority = new long[numpoints];
+	char *vertextypes = TPPLNewArray<char>(numpoints);
+	long *priority = TPPLNewArray<long>(numpoints);
 
 	//merge left and right vertex chains
 	priority[0] = topindex;
@@ -1490,7 +1528,7 @@ int ToveTPPLPartition::TriangulateMonotone(ToveTPPLPoly *inPoly, TPPLPolyList *t
 	priority[i] = bottomindex;
 	vertextypes[bottomindex] = 0;
 
-	long *stack = new long[numpoints];
+	long *stack = TPPLNewArray<long>(numpoints);
 	long stackptr = 0;
 
 	stack[0] = priority[0];
@@ -1548,9 +1586,9 @@ int ToveTPPLPartition::TriangulateMonotone(ToveTPPLPoly *inPoly, TPPLPolyList *t
 		triangles->push_back(triangle);
 	}
 
-	delete [] priority;
-	delete [] vertextypes;
-	delete [] stack;
+	TPPLDeleteArray(priority, numpoints);
+	TPPLDeleteArray(vertextypes, numpoints);
+	TPPLDeleteArray(stack, numpoints);
 
 	return 1;
 }
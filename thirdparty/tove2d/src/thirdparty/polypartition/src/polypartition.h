@@ -24,6 +24,8 @@
 #include <list>
 #include <set>
 #include <cassert>
+#include <cstddef>
+#include <new>
 
 typedef double tppl_float;
 
@@ -78,6 +80,72 @@ struct TPPLPoint {
 };
 
 
+//Scratch memory hook (tove). While a TPPLScratch is active on the calling
+//thread, polygon points and list nodes are carved from it and individual
+//frees become no-ops; the scratch's owner releases everything at once.
+class TPPLScratch {
+    public:
+        virtual ~TPPLScratch() {}
+
+        //returns at least size bytes, aligned like max_align_t
+        virtual void *Allocate(size_t size) = 0;
+
+        static TPPLScratch *GetActive();
+        static void SetActive(TPPLScratch *scratch);
+};
+
+void *TPPLAllocate(size_t size);
+void TPPLFree(void *p);
+
+template<typename T>
+struct TPPLScratchAllocator {
+    typedef T value_type;
+
+    TPPLScratchAllocator() {
+    }
+
+    template<typename U>
+    TPPLScratchAllocator(const TPPLScratchAllocator<U> &) {
+    }
+
+    T *allocate(size_t n) {
+        return static_cast<T*>(TPPLAllocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t) {
+        TPPLFree(p);
+    }
+
+    template<typename U>
+    bool operator==(const TPPLScratchAllocator<U> &) const {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const TPPLScratchAllocator<U> &) const {
+        return false;
+    }
+};
+
+#ifndef TPPL_ALLOCATOR
+#define TPPL_ALLOCATOR(t) TPPLScratchAllocator<t>
+#endif
+
+//new[] and delete[] for the per-call work arrays, through TPPLAllocate
+template<typename T>
+T *TPPLNewArray(long n) {
+    T *p = static_cast<T*>(TPPLAllocate(n * sizeof(T)));
+    for(long i = 0; i < n; i++) new(p + i) T();
+    return p;
+}
+
+template<typename T>
+void TPPLDeleteArray(T *p, long n) {
+    if(!p) return;
+    for(long i = 0; i < n; i++) p[i].~T();
+    TPPLFree(p);
+}
+
 //Polygon implemented as an array of points with a 'hole' flag
 class ToveTPPLPoly {
     protected:
@@ -233,6 +301,12 @@ class ToveTPPLPartition {
             
             bool IsConvex(const TPPLPoint& p1, const TPPLPoint& p2, const TPPLPoint& p3) const;
         };
+
+#ifdef TPPL_ALLOCATOR
+        typedef std::set<ScanLineEdge, std::less<ScanLineEdge>, TPPL_ALLOCATOR(ScanLineEdge)> ScanLineEdgeSet;
+#else
+        typedef std::set<ScanLineEdge> ScanLineEdgeSet;
+#endif
         
         //standard helper functions
         bool IsConvex(TPPLPoint& p1, TPPLPoint& p2, TPPLPoint& p3);
@@ -259,8 +333,8 @@ class ToveTPPLPartition {
         //helper functions for MonotonePartition
         bool Below(TPPLPoint &p1, TPPLPoint &p2);
         void AddDiagonal(MonotoneVertex *vertices, long *numvertices, long index1, long index2,
-            char *vertextypes, std::set<ScanLineEdge>::iterator *edgeTreeIterators,
-            std::set<ScanLineEdge> *edgeTree, long *helpers);
+            char *vertextypes, ScanLineEdgeSet::iterator *edgeTreeIterators,
+            ScanLineEdgeSet *edgeTree, long *helpers);
         
         //triangulates a monotone polygon, used in Triangulate_MONO
         int TriangulateMonotone(ToveTPPLPoly *inPoly, TPPLPolyList *triangles);
@@ -3,14 +3,200 @@
 /*************************************************************************/
 
 #include "utils.h"
-#include "core/string/string_builder.h"
+#include "core/object/worker_thread_pool.h"
+#include "core/os/mutex.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "scene/resources/image_texture.h"
 #include "scene/resources/surface_tool.h"
 
+#include "modules/svg_mesh/thirdparty/tove2d/src/cpp/mesh/flatten.h"
 #include "modules/svg_mesh/thirdparty/tove2d/src/cpp/mesh/mesh.h"
 #include "modules/svg_mesh/thirdparty/tove2d/src/cpp/mesh/meshifier.h"
+#include "modules/svg_mesh/thirdparty/tove2d/src/cpp/nsvg.h"
 #include "modules/svg_mesh/thirdparty/tove2d/src/cpp/shader/feed/color_feed.h"
 
+// parse contexts shared by every thread that loads svgs (imports run on
+// several), instead of one per thread that lives as long as the thread. each
+// releases its buffers past the retain limit after a parse, and at most
+// SVG_PARSE_CONTEXT_POOL_SIZE idle ones are kept.
+static constexpr uint32_t SVG_PARSE_CONTEXT_POOL_SIZE = 4;
+static constexpr size_t SVG_PARSE_CONTEXT_RETAIN_LIMIT = 256 * 1024;
+
+static Mutex parse_context_mutex;
+static LocalVector<tove::nsvg::ParseContext *> parse_contexts;
+
+static tove::nsvg::ParseContext *acquire_parse_context() {
+	{
+		MutexLock lock(parse_context_mutex);
+		if (!parse_contexts.is_empty()) {
+			tove::nsvg::ParseContext *context = parse_contexts[parse_contexts.size() - 1];
+			parse_contexts.resize(parse_contexts.size() - 1);
+			return context;
+		}
+	}
+	return memnew(tove::nsvg::ParseContext(SVG_PARSE_CONTEXT_RETAIN_LIMIT));
+}
+
+static void release_parse_context(tove::nsvg::ParseContext *p_context) {
+	{
+		MutexLock lock(parse_context_mutex);
+		if (parse_contexts.size() < SVG_PARSE_CONTEXT_POOL_SIZE) {
+			parse_contexts.push_back(p_context);
+			return;
+		}
+	}
+	memdelete(p_context);
+}
+
+void free_svg_parse_contexts() {
+	MutexLock lock(parse_context_mutex);
+	for (tove::nsvg::ParseContext *context : parse_contexts) {
+		memdelete(context);
+	}
+	parse_contexts.clear();
+}
+
+tove::GraphicsRef load_svg_graphics(const String &p_path, const char *p_units, float p_dpi) {
+	Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::READ);
+	ERR_FAIL_COND_V_MSG(f.is_null(), tove::GraphicsRef(), "Cannot open SVG file '" + p_path + "'.");
+
+	const uint64_t len = f->get_length();
+	if (len == 0) {
+		return tove::GraphicsRef();
+	}
+
+	// the xml parser reads utf-8 (and skips a BOM) by itself, so the file's
+	// bytes only need a terminator to be handed over as they are.
+	LocalVector<char> buf;
+	buf.resize(len + 1);
+	const uint64_t read = f->get_buffer((uint8_t *)buf.ptr(), len);
+	buf[read] = '\0';
+
+	tove::nsvg::ParseContext *context = acquire_parse_context();
+	tove::GraphicsRef graphics = tove::Graphics::createFromSVG(buf.ptr(), p_units, p_dpi, context);
+	release_parse_context(context);
+	return graphics;
+}
+
+class WorkerThreadPoolExecutor : public tove::ParallelExecutor {
+	struct Call {
+		Job job;
+		void *userdata;
+	};
+
+	static void _run_job(void *p_call, uint32_t p_index) {
+		const Call *call = static_cast<const Call *>(p_call);
+		call->job(call->userdata, p_index);
+	}
+
+public:
+	virtual void run(int p_count, Job p_job, void *p_userdata) override {
+		WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+		if (p_count < 2 || pool->get_thread_index() != -1) {
+			// waiting on a group from inside the pool could starve it.
+			for (int i = 0; i < p_count; i++) {
+				p_job(p_userdata, i);
+			}
+			return;
+		}
+
+		Call call = { p_job, p_userdata };
+		WorkerThreadPool::GroupID group_id = pool->add_native_group_task(
+				&WorkerThreadPoolExecutor::_run_job, &call, p_count, -1, true, SNAME("VGFlatten"));
+		pool->wait_for_group_task_completion(group_id);
+	}
+};
+
+tove::ParallelExecutor *get_worker_thread_pool_executor() {
+	static WorkerThreadPoolExecutor executor;
+	return &executor;
+}
+
+// srgb_to_linear() for every 8-bit channel value, so converting tove's
+// vertex colors is a lookup instead of a pow() per channel.
+struct SRGBToLinearTable {
+	float values[256];
+
+	SRGBToLinearTable() {
+		for (int i = 0; i < 256; i++) {
+			values[i] = Color(i / 255.0, 0, 0).srgb_to_linear().r;
+		}
+	}
+};
+
+void copy_mesh_vertices(const tove::MeshRef &p_tove_mesh, const Vector3 &p_offset, Vector3 *r_vertices, Color *r_colors) {
+	const int n = p_tove_mesh->getVertexCount();
+
+	if (p_tove_mesh->getLayout() == tove::VERTEX_LAYOUT_SPLIT) {
+		// packed arrays; keep these loops free of strides so they vectorize.
+		const tove::vec2 *p = p_tove_mesh->getPositionData();
+		for (int i = 0; i < n; i++) {
+			r_vertices[i] = Vector3(p[i].x * 0.001f + p_offset.x, p[i].y * -0.001f + p_offset.y, p_offset.z);
+		}
+	} else {
+		const int position_stride = p_tove_mesh->getPositionStride();
+		const uint8_t *position_data = (const uint8_t *)p_tove_mesh->getPositionData();
+		for (int i = 0; i < n; i++) {
+			const float *p = (const float *)(position_data + i * position_stride);
+			r_vertices[i] = Vector3(p[0] * 0.001f + p_offset.x, p[1] * -0.001f + p_offset.y, p_offset.z);
+		}
+	}
+
+	if (r_colors) {
+		copy_mesh_colors(p_tove_mesh, r_colors);
+	}
+}
+
+// unlike tove's gradient evaluation (paint.cpp), this stays scalar: each
+// channel is a table lookup, which SSE2 has no gather for, and the pass is
+// bound by writing 16 byte Colors anyway (tests/layout_bench in tove2d).
+void copy_mesh_colors(const tove::MeshRef &p_tove_mesh, Color *r_colors) {
+	static const SRGBToLinearTable srgb_to_linear;
+
+	const int n = p_tove_mesh->getVertexCount();
+	const float *lut = srgb_to_linear.values;
+
+	if (p_tove_mesh->getLayout() == tove::VERTEX_LAYOUT_SPLIT) {
+		const uint8_t *c = p_tove_mesh->getAttributeData();
+		for (int i = 0; i < n; i++) {
+			r_colors[i] = Color(lut[c[4 * i + 0]], lut[c[4 * i + 1]], lut[c[4 * i + 2]], c[4 * i + 3] / 255.0f);
+		}
+		return;
+	}
+
+	const int color_stride = p_tove_mesh->getAttributeStride();
+	const uint8_t *color_data = p_tove_mesh->getAttributeData();
+	for (int i = 0; i < n; i++) {
+		const uint8_t *c = color_data + i * color_stride;
+		r_colors[i] = Color(lut[c[0]], lut[c[1]], lut[c[2]], c[3] / 255.0f);
+	}
+}
+
+void copy_mesh_indices(const tove::MeshRef &p_tove_mesh, int32_t p_base, int32_t *r_indices) {
+	p_tove_mesh->copyIndexData(r_indices, p_tove_mesh->getIndexCount(), p_base);
+}
+
+void add_planar_normals(Array &r_arrays, int p_vertex_count) {
+	Vector<Vector3> narr;
+	Vector<float> tarr;
+	ERR_FAIL_COND(narr.resize(p_vertex_count) != OK);
+	ERR_FAIL_COND(tarr.resize(p_vertex_count * 4) != OK);
+
+	Vector3 *w_normals = narr.ptrw();
+	float *w_tangents = tarr.ptrw();
+	for (int i = 0; i < p_vertex_count; i++) {
+		w_normals[i] = Vector3(0, 0, 1);
+		w_tangents[i * 4 + 0] = 1.0f;
+		w_tangents[i * 4 + 1] = 0.0f;
+		w_tangents[i * 4 + 2] = 0.0f;
+		w_tangents[i * 4 + 3] = 1.0f;
+	}
+
+	r_arrays[Mesh::ARRAY_NORMAL] = narr;
+	r_arrays[Mesh::ARRAY_TANGENT] = tarr;
+}
+
 tove::PathRef new_transformed_path(const tove::PathRef &p_tove_path, const Transform2D &p_transform) {
 	const Vector2 &tx = p_transform.columns[0];
 	const Vector2 &ty = p_transform.columns[1];
@@ -22,12 +208,206 @@ tove::PathRef new_transformed_path(const tove::PathRef &p_tove_path, const Trans
 	return tove_path;
 }
 
+tove::GraphicsRef new_clip_graphics(const tove::GraphicsRef &p_tove_graphics) {
+	const tove::ClipSetRef &clips = p_tove_graphics->getClipSet();
+	if (!clips) {
+		return tove::tove_make_shared<tove::Graphics>(tove::ClipSetRef());
+	}
+	return tove::tove_make_shared<tove::Graphics>(
+			tove::tove_make_shared<tove::ClipSet>(*clips.get(), tove::nsvg::Transform()));
+}
+
+// gradients for PaintMeshes. UV.y picks the paint's gradient matrix and
+// radial mix in paint_data, UV.x its color ramp in the texture.
+// clang-format off
+static const char *canvas_gradient_shader_code = R"GLSL(
+shader_type canvas_item;
+
+uniform sampler2D paint_data : filter_nearest;
+
+varying smooth mediump vec2 gradient_pos;
+varying flat mediump vec3 gradient_scale;
+varying flat mediump float paint;
+
+void vertex()
+{
+	int i = int(floor(UV.y * float(textureSize(paint_data, 0).x)));
+	vec4 c0 = texelFetch(paint_data, ivec2(i, 0), 0);
+	vec4 c1 = texelFetch(paint_data, ivec2(i, 1), 0);
+	vec4 c2 = texelFetch(paint_data, ivec2(i, 2), 0);
+	mat3 m = mat3(c0.xyz, c1.xyz, c2.xyz);
+	float cstep = 0.5 * TEXTURE_PIXEL_SIZE.y;
+
+	gradient_pos = (m * vec3(VERTEX.xy, 1)).xy;
+	gradient_scale = vec3(cstep, 1.0f - 2.0f * cstep, c0.w);
+
+	paint = UV.x;
+}
+
+void fragment()
+{
+	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
+	y = gradient_scale.x + gradient_scale.y * y;
+
+	vec2 texture_pos_exact = vec2(paint, y);
+	COLOR = texture(TEXTURE, texture_pos_exact);
+}
+)GLSL";
+
+static const char *spatial_gradient_shader_code = R"GLSL(
+shader_type spatial;
+render_mode cull_disabled;
+
+uniform sampler2D tex : source_color;
+uniform sampler2D paint_data : filter_nearest;
+
+varying smooth highp vec3 gradient_pos;
+varying flat highp vec3 gradient_scale;
+varying flat highp float paint;
+
+void vertex()
+{
+	int i = int(floor(UV.y * float(textureSize(paint_data, 0).x)));
+	vec4 c0 = texelFetch(paint_data, ivec2(i, 0), 0);
+	vec4 c1 = texelFetch(paint_data, ivec2(i, 1), 0);
+	vec4 c2 = texelFetch(paint_data, ivec2(i, 2), 0);
+	mat3 m = mat3(c0.xyz, c1.xyz, c2.xyz);
+	float cstep = 0.5 / float(textureSize(tex, 0).y);
+
+	gradient_pos = m * VERTEX.xyz;
+	gradient_scale = vec3(cstep, 1.0f - 2.0f * cstep, c0.w);
+
+	paint = UV.x;
+}
+
+void fragment()
+{
+	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
+	y = gradient_scale.x + gradient_scale.y * y;
+
+	vec2 texture_pos_exact = vec2(paint, -y);
+	ALBEDO = textureLod(tex, texture_pos_exact, 0).rgb;
+	ALPHA = textureLod(tex, texture_pos_exact, 0).a;
+}
+)GLSL";
+// clang-format on
+
+static Ref<Shader> gradient_shaders[2];
+
+// one shader per kind, shared by all gradient meshes so that none of them
+// compiles anything of its own.
+static Ref<Shader> get_gradient_shader(bool p_spatial) {
+	Ref<Shader> &shader = gradient_shaders[p_spatial ? 1 : 0];
+	if (shader.is_null()) {
+		shader.instantiate();
+		shader->set_code(p_spatial ? spatial_gradient_shader_code : canvas_gradient_shader_code);
+	}
+	return shader;
+}
+
+// color ramps of all gradient meshes, one column each and shared by content,
+// so that gradient meshes end up on a few shared textures. pages only grow;
+// ramps come from baking meshes, which is rare enough not to evict.
+static const int GRADIENT_RAMP_SIZE = 256;
+static const int GRADIENT_ATLAS_WIDTH = 512;
+
+struct GradientRampPage {
+	Ref<Image> image;
+	Ref<ImageTexture> texture;
+	HashMap<uint32_t, int> columns;
+	int used = 0;
+
+	bool has_ramp(int p_column, const uint8_t *p_ramp) const {
+		const int width = image->get_width();
+		const uint8_t *r = image->ptr();
+		for (int y = 0; y < GRADIENT_RAMP_SIZE; y++) {
+			if (memcmp(r + (y * width + p_column) * 4, p_ramp + y * 4, 4) != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int find_ramp(uint32_t p_hash, const uint8_t *p_ramp) const {
+		const int *column = columns.getptr(p_hash);
+		return column && has_ramp(*column, p_ramp) ? *column : -1;
+	}
+
+	int add_ramp(uint32_t p_hash, const uint8_t *p_ramp) {
+		const int width = image->get_width();
+		uint8_t *w = image->ptrw();
+		for (int y = 0; y < GRADIENT_RAMP_SIZE; y++) {
+			memcpy(w + (y * width + used) * 4, p_ramp + y * 4, 4);
+		}
+		if (!columns.has(p_hash)) {
+			columns.insert(p_hash, used);
+		}
+		return used++;
+	}
+};
+
+static LocalVector<GradientRampPage *> gradient_ramp_pages;
+
+// puts p_count ramps (GRADIENT_RAMP_SIZE rgba8 texels each, one after the
+// other) on one page, reusing the ones already there.
+static GradientRampPage *atlas_gradient_ramps(const uint8_t *p_ramps, int p_count, LocalVector<int> &r_columns) {
+	const int ramp_bytes = GRADIENT_RAMP_SIZE * 4;
+	LocalVector<uint32_t> hashes;
+	hashes.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		hashes[i] = hash_murmur3_buffer(p_ramps + i * ramp_bytes, ramp_bytes);
+	}
+
+	GradientRampPage *page = gradient_ramp_pages.is_empty() ? nullptr : gradient_ramp_pages[gradient_ramp_pages.size() - 1];
+	int missing = 0;
+	if (page) {
+		for (int i = 0; i < p_count; i++) {
+			if (page->find_ramp(hashes[i], p_ramps + i * ramp_bytes) < 0) {
+				missing++;
+			}
+		}
+	}
+	if (!page || page->used + missing > page->image->get_width()) {
+		page = memnew(GradientRampPage);
+		page->image = Image::create_empty(MAX(GRADIENT_ATLAS_WIDTH, p_count), GRADIENT_RAMP_SIZE, false, Image::FORMAT_RGBA8);
+		page->texture = ImageTexture::create_from_image(page->image);
+		gradient_ramp_pages.push_back(page);
+	}
+
+	bool added = false;
+	r_columns.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		const uint8_t *ramp = p_ramps + i * ramp_bytes;
+		int column = page->find_ramp(hashes[i], ramp);
+		if (column < 0) {
+			column = page->add_ramp(hashes[i], ramp);
+			added = true;
+		}
+		r_columns[i] = column;
+	}
+	if (added) {
+		page->texture->update(page->image);
+	}
+	return page;
+}
+
+void free_gradient_resources() {
+	gradient_shaders[0].unref();
+	gradient_shaders[1].unref();
+
+	for (GradientRampPage *page : gradient_ramp_pages) {
+		memdelete(page);
+	}
+	gradient_ramp_pages.clear();
+}
+
 Ref<ShaderMaterial> copy_mesh(
 		Ref<ArrayMesh> &p_mesh,
 		tove::MeshRef &p_tove_mesh,
 		const tove::GraphicsRef &p_graphics,
 		Ref<Texture> &r_texture,
-		bool p_spatial) {
+		bool p_spatial,
+		bool p_planar) {
 
 	const int n = p_tove_mesh->getVertexCount();
 	if (n < 1) {
@@ -36,45 +416,21 @@ Ref<ShaderMaterial> copy_mesh(
 
 	const bool isPaintMesh = std::dynamic_pointer_cast<tove::PaintMesh>(p_tove_mesh).get() != nullptr;
 
-	const int stride = isPaintMesh ? sizeof(float) * 3 : sizeof(float) * 2 + 4;
-	const int size = n * stride;
-
-	Vector<uint8_t> vvertices;
-	vvertices.resize(size);
-	p_tove_mesh->copyVertexData(vvertices.ptrw(), size);
-
 	const int index_count = p_tove_mesh->getIndexCount();
-	Vector<ToveVertexIndex> vindices;
-	vindices.resize(index_count);
-	p_tove_mesh->copyIndexData(vindices.ptrw(), index_count);
-
 	Vector<int> iarr;
 	ERR_FAIL_COND_V(iarr.resize(index_count) != OK, Ref<ShaderMaterial>());
-	{
-		for (int i = 0; i < index_count; i++) {
-			iarr.write[i] = vindices[i];
-		}
-	}
+	copy_mesh_indices(p_tove_mesh, 0, iarr.ptrw());
 
 	Vector<Vector3> varr;
 	ERR_FAIL_COND_V(varr.resize(n) != OK, Ref<ShaderMaterial>());
 
-	{
-		for (int i = 0; i < n; i++) {
-			float *p = (float *)(vvertices.ptrw() + i * stride);
-			varr.write[i] = Vector3(p[0], p[1], 0) * Vector3(0.001, -0.001, 0.001);
-		}
-	}
-
 	Vector<Color> carr;
 	if (!isPaintMesh) {
 		ERR_FAIL_COND_V(carr.resize(n) != OK, Ref<ShaderMaterial>());
-		for (int i = 0; i < n; i++) {
-			uint8_t *p = vvertices.ptrw() + i * stride + 2 * sizeof(float);
-			carr.write[i] = Color(p[0] / 255.0, p[1] / 255.0, p[2] / 255.0, p[3] / 255.0).srgb_to_linear();
-		}
 	}
 
+	copy_mesh_vertices(p_tove_mesh, Vector3(), varr.ptrw(), isPaintMesh ? nullptr : carr.ptrw());
+
 	Vector<Vector2> uvs;
 	Ref<Material> material;
 
@@ -114,176 +470,80 @@ Ref<ShaderMaterial> copy_mesh(
 		feed->beginUpdate();
 		feed->endUpdate();
 
-		Vector<uint8_t> paint_seen;
-		ERR_FAIL_COND_V(paint_seen.resize(npaints) != OK, Ref<ShaderMaterial>());
-		memset(paint_seen.ptrw(), 0, npaints);
-
-		ERR_FAIL_COND_V(uvs.resize(n) != OK, Ref<ShaderMaterial>());
-		{
-			for (int i = 0; i < n; i++) {
-				const float *p = (float *)(vvertices.ptrw() + i * stride);
-				int paint_index = p[2];
-				uvs.write[i] = Vector2((paint_index + 0.5f) / npaints, 0.0f);
-				paint_seen.write[paint_index] = 1;
+		// bring every paint's ramp to the atlas' height. with a zero matrix
+		// (solid colors) only the first texel is ever read.
+		const int num_colors = alloc.numColors;
+		LocalVector<uint8_t> ramps;
+		ramps.resize(npaints * GRADIENT_RAMP_SIZE * 4);
+		for (int paint_i = 0; paint_i < npaints; paint_i++) {
+			bool solid = true;
+			for (int j = 0; j < 3 * matrix_rows; j++) {
+				solid = solid && matrix_data[paint_i * 3 * matrix_rows + j] == 0.0f;
+			}
+			const uint8_t *c0 = pixels.ptr() + paint_i * 4;
+			uint8_t *ramp = ramps.ptr() + paint_i * GRADIENT_RAMP_SIZE * 4;
+			for (int y = 0; y < GRADIENT_RAMP_SIZE; y++) {
+				if (solid || num_colors == 1) {
+					memcpy(ramp + y * 4, c0, 4);
+				} else if (num_colors == GRADIENT_RAMP_SIZE) {
+					memcpy(ramp + y * 4, c0 + y * npaints * 4, 4);
+				} else {
+					// two stops; what the sampler would have interpolated.
+					const uint8_t *c1 = c0 + npaints * 4;
+					const float t = y / float(GRADIENT_RAMP_SIZE - 1);
+					for (int k = 0; k < 4; k++) {
+						ramp[y * 4 + k] = uint8_t(Math::round(Math::lerp(float(c0[k]), float(c1[k]), t)));
+					}
+				}
 			}
 		}
 
-		Ref<Image> image = memnew(Image(
-				alloc.numPaints,
-				alloc.numColors,
-				false,
-				Image::FORMAT_RGBA8,
-				pixels));
-
-		Ref<ImageTexture> texture = Ref<ImageTexture>(memnew(ImageTexture));
-		texture->create_from_image(image);
+		LocalVector<int> columns;
+		GradientRampPage *page = atlas_gradient_ramps(ramps.ptr(), npaints, columns);
+		Ref<ImageTexture> texture = page->texture;
 		r_texture = texture;
 
-		Ref<Shader> shader;
-		shader.instantiate();
-
-		StringBuilder code;
-		String s;
-		for (int32_t paint_i = 0; paint_i < alloc.numPaints; paint_i++) {
-			bool has_seen = paint_seen[paint_i];
-			if (!has_seen) {
-				continue;
-			}
-
-			code += "if(i==";
-			s = String::num_int64(paint_i);
-			code += s;
-			code += "){";
-
-			const float &v = arguments_data.write[paint_i];
-			code += "a=";
-			s = String::num_real(v);
-			if (!s.is_numeric()) {
-				s = "0.0";
+		// u picks the ramp in the atlas, v the paint's data.
+		const float atlas_width = page->image->get_width();
+		ERR_FAIL_COND_V(uvs.resize(n) != OK, Ref<ShaderMaterial>());
+		{
+			const uint8_t *paint_data = p_tove_mesh->getAttributeData();
+			const int stride = p_tove_mesh->getAttributeStride();
+			for (int i = 0; i < n; i++) {
+				int paint_index = *(const float *)(paint_data + i * stride);
+				uvs.write[i] = Vector2((columns[paint_index] + 0.5f) / atlas_width, (paint_index + 0.5f) / npaints);
 			}
-			code += s;
-			code += ";";
+		}
 
+		// three texels per paint: the columns of its gradient matrix, with
+		// the radial mix in the first one's alpha.
+		Vector<uint8_t> paint_data;
+		ERR_FAIL_COND_V(paint_data.resize(npaints * 3 * 4 * sizeof(float)) != OK, Ref<ShaderMaterial>());
+		float *w_paint_data = reinterpret_cast<float *>(paint_data.ptrw());
+		for (int paint_i = 0; paint_i < npaints; paint_i++) {
 			const int j0 = paint_i * 3 * matrix_rows;
-			code += "m=mat3(";
-
 			for (int j = 0; j < 3; j++) {
-				if (j > 0) {
-					code += "),";
-				}
-				code += "vec3(";
+				float *texel = w_paint_data + (j * npaints + paint_i) * 4;
 				for (int k = 0; k < 3; k++) {
-					if (k > 0) {
-						code += ",";
-					}
-					float elem = matrix_data[j0 + j + k * 3];
-					if (!Math::is_nan(elem)) {
-						s = String::num_real(elem);
-					} else {
-						s = "0.0f";
-					}
-					if (!s.is_numeric()) {
-						s = "0.0";
-					}
-					code += s;
+					const float elem = matrix_data[j0 + j + k * 3];
+					texel[k] = Math::is_finite(elem) ? elem : 0.0f;
 				}
+				const float a = arguments_data[paint_i];
+				texel[3] = (j == 0 && Math::is_finite(a)) ? a : 0.0f;
 			}
-			code += "));}\n";
 		}
-		if (!p_spatial) {
-			// clang-format off
-        String shader_code = String(R"GLSL(
-shader_type canvas_item;
-
-varying smooth mediump vec2 gradient_pos;
-varying flat mediump vec3 gradient_scale;
-varying flat mediump float paint;
-
-void vertex()
-{
-    int i = int(floor(UV.x * NPAINTS));
-    float a;
-    mat3 m;
-
-)GLSL") +  code.as_string() + String(R"GLSL(
-
-	gradient_pos = (m * vec3(VERTEX.xy, 1)).xy;
-	gradient_scale = vec3(CSTEP, 1.0f - 2.0f * CSTEP, a);
-
-	paint = UV.x;
-}
-
-void fragment()
-{
-	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
-	y = gradient_scale.x + gradient_scale.y * y;
-
-	vec2 texture_pos_exact = vec2(paint, y);
-	COLOR = texture(TEXTURE, texture_pos_exact);
-}
-
-)GLSL");
-			// clang-format on
-			String npaints_str = String::num_real(static_cast<double>(npaints));
-			String cstep_str = String::num_real(static_cast<double>(0.5f / alloc.numColors));
 
-			shader_code = shader_code.replace("NPAINTS", npaints_str.utf8().get_data());
-			shader_code = shader_code.replace("CSTEP", cstep_str.utf8().get_data());
-			shader->set_code(shader_code);
+		Ref<ImageTexture> paint_texture = ImageTexture::create_from_image(
+				Image::create_from_data(npaints, 3, false, Image::FORMAT_RGBAF, paint_data));
 
-			Ref<ShaderMaterial> shader_material;
-			shader_material.instantiate();
-			shader_material->set_shader(shader);
-			material = shader_material;
-		} else {
-			// clang-format off
-        String shader_code = String(R"GLSL(shader_type spatial;
-
-varying smooth highp vec3 gradient_pos;
-varying flat highp vec3 gradient_scale;
-varying flat highp float paint;
-uniform sampler2D tex : hint_albedo;
-render_mode cull_disabled;
-
-void vertex()
-{
-    int i = int(floor(UV.x * NPAINTS));
-    float a;
-    mat3 m;
-
-)GLSL") +  code.as_string() + String(R"GLSL(
-
-	gradient_pos = m * VERTEX.xyz;
-	gradient_scale = vec3(CSTEP, 1.0f - 2.0f * CSTEP, a);
-
-	paint = UV.x;
-}
-
-void fragment()
-{
-	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
-	y = gradient_scale.x + gradient_scale.y * y;
-
-	vec2 texture_pos_exact = vec2(paint, -y);
-	ALBEDO = textureLod(tex, texture_pos_exact, 0).rgb;
-	ALPHA = textureLod(tex, texture_pos_exact, 0).a;
-}
-
-)GLSL");
-			// clang-format on
-			String npaints_str = String::num_real(static_cast<double>(npaints));
-			String cstep_str = String::num_real(static_cast<double>(0.5f) / static_cast<double>(alloc.numColors));
-
-			shader_code = shader_code.replace("NPAINTS", npaints_str.utf8().get_data());
-			shader_code = shader_code.replace("CSTEP", cstep_str.utf8().get_data());
-			shader->set_code(shader_code);
-
-			Ref<ShaderMaterial> mat;
-			mat.instantiate();
-			mat->set_shader_parameter("tex", texture);
-			mat->set_shader(shader);
-			material = mat;
+		Ref<ShaderMaterial> shader_material;
+		shader_material.instantiate();
+		shader_material->set_shader(get_gradient_shader(p_spatial));
+		shader_material->set_shader_parameter("paint_data", paint_texture);
+		if (p_spatial) {
+			shader_material->set_shader_parameter("tex", texture);
 		}
+		material = shader_material;
 	}
 
 	Array arr;
@@ -297,10 +557,16 @@ void fragment()
 		arr[RS::ARRAY_TEX_UV] = uvs;
 	}
 
+	if (p_planar) {
+		// tove's indexed triangles can go out as they are.
+		add_planar_normals(arr, n);
+		p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr);
+		return material;
+	}
+
 	Ref<SurfaceTool> surface_tool;
 	surface_tool.instantiate();
 	surface_tool->create_from_triangle_arrays(arr);
-	surface_tool->index();
 	surface_tool->generate_normals();
 	surface_tool->generate_tangents();
 
@@ -44,13 +44,54 @@ inline Rect2 tove_bounds_to_rect2(const float *bounds) {
 	return Rect2(bounds[0], bounds[1], bounds[2] - bounds[0], bounds[3] - bounds[1]);
 }
 
+// the rendering server's encoding of ARRAY_COLOR, for region updates.
+inline void encode_mesh_color(const Color &p_color, uint8_t *r_rgba) {
+	r_rgba[0] = uint8_t(CLAMP(p_color.r * 255.0, 0.0, 255.0));
+	r_rgba[1] = uint8_t(CLAMP(p_color.g * 255.0, 0.0, 255.0));
+	r_rgba[2] = uint8_t(CLAMP(p_color.b * 255.0, 0.0, 255.0));
+	r_rgba[3] = uint8_t(CLAMP(p_color.a * 255.0, 0.0, 255.0));
+}
+
+namespace tove {
+class ParallelExecutor;
+}
+
+// lets tove spread work (e.g. a path's subpaths) over the WorkerThreadPool.
+// runs jobs inline when called from a pool thread, so it is safe to use
+// from tessellation that is itself already running on the pool.
+tove::ParallelExecutor *get_worker_thread_pool_executor();
+
+// parses an svg file straight from its bytes, without a String round trip,
+// using a context from a small shared pool. safe to call from any thread.
+tove::GraphicsRef load_svg_graphics(const String &p_path, const char *p_units = "px", float p_dpi = 96.0);
+// frees the pooled parse contexts.
+void free_svg_parse_contexts();
+
 tove::PathRef new_transformed_path(const tove::PathRef &p_tove_path, const Transform2D &p_transform);
+// a graphics that holds only a private copy of p_tove_graphics' clip set,
+// which is all a tesselator reads from its graphics. lets worker threads
+// tessellate without touching the scene's graphics.
+tove::GraphicsRef new_clip_graphics(const tove::GraphicsRef &p_tove_graphics);
+
+// converts tove's vertices in either layout (svg units, y down) into mesh units
+// with y up, translated by p_offset. r_colors may be null for a PaintMesh.
+void copy_mesh_vertices(const tove::MeshRef &p_tove_mesh, const Vector3 &p_offset, Vector3 *r_vertices, Color *r_colors);
+// converts only the vertex colors of a ColorMesh, into linear space.
+void copy_mesh_colors(const tove::MeshRef &p_tove_mesh, Color *r_colors);
+void copy_mesh_indices(const tove::MeshRef &p_tove_mesh, int32_t p_base, int32_t *r_indices);
+
+// vector geometry lies in the z = 0 plane, so every vertex shares one normal and tangent.
+void add_planar_normals(Array &r_arrays, int p_vertex_count);
+
+// releases the shared gradient shaders and ramps before the servers go away.
+void free_gradient_resources();
 
 Ref<ShaderMaterial> copy_mesh(
 		Ref<ArrayMesh> &p_mesh,
 		tove::MeshRef &p_tove_mesh,
 		const tove::GraphicsRef &p_graphics,
 		Ref<Texture> &r_texture,
-		bool p_spatial = false);
+		bool p_spatial = false,
+		bool p_planar = true);
 
 #endif // UTILS_H
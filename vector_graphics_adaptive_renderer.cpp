@@ -6,14 +6,47 @@
 #include "modules/svg_mesh/thirdparty/tove2d/src/cpp/mesh/meshifier.h"
 
 VGMeshRenderer::VGMeshRenderer() :
-		quality(1) {
+		quality(1),
+		triangulation(TRIANGULATION_EAR_CLIPPING),
+		flattener(FLATTENER_RECURSIVE) {
 	create_tesselator();
 }
 
 void VGMeshRenderer::create_tesselator() {
-	tesselator = tove::tove_make_shared<tove::AdaptiveTesselator>(
-			new tove::AdaptiveFlattener<tove::DefaultCurveFlattener>(
-					tove::DefaultCurveFlattener(2 * quality, 6)));
+	// only the renderer's own tesselator flattens in parallel; the ones from
+	// new_tesselator() already run on worker threads.
+	tesselator = make_tesselator(get_worker_thread_pool_executor());
+}
+
+tove::TesselatorRef VGMeshRenderer::make_tesselator(tove::ParallelExecutor *p_executor) const {
+	tove::AbstractAdaptiveFlattener *curve_flattener;
+	if (flattener == FLATTENER_WANG) {
+		curve_flattener = new tove::AdaptiveFlattener<tove::WangCurveFlattener>(
+				tove::WangCurveFlattener(2 * quality, 6));
+	} else if (flattener == FLATTENER_ANTIGRAIN) {
+		// agg's defaults, with the angle check on so that sharp turns and
+		// cusps get refined; the tolerance gives about the point count of
+		// the recursive flattener at the same quality.
+		AntiGrainSettings settings;
+		settings.distanceTolerance = 0.25f / MAX(quality, 0.01f);
+		settings.colinearityEpsilon = 1e-30f;
+		settings.angleEpsilon = 0.01f;
+		settings.angleTolerance = Math::deg_to_rad(15.0f);
+		settings.cuspLimit = 0.0f;
+		curve_flattener = new tove::AdaptiveFlattener<tove::AntiGrainFlattener>(
+				tove::AntiGrainFlattener(settings, 6));
+	} else {
+		curve_flattener = new tove::AdaptiveFlattener<tove::DefaultCurveFlattener>(
+				tove::DefaultCurveFlattener(2 * quality, 6));
+	}
+	curve_flattener->setExecutor(p_executor);
+	return tove::tove_make_shared<tove::AdaptiveTesselator>(
+			curve_flattener,
+			triangulation == TRIANGULATION_MONOTONE ? TOVE_TRIANGULATION_MONOTONE : TOVE_TRIANGULATION_EAR_CLIPPING);
+}
+
+tove::TesselatorRef VGMeshRenderer::new_tesselator() const {
+	return make_tesselator(nullptr);
 }
 
 float VGMeshRenderer::get_quality() {
@@ -26,9 +59,44 @@ void VGMeshRenderer::set_quality(float p_quality) {
 	emit_changed();
 }
 
+VGMeshRenderer::Triangulation VGMeshRenderer::get_triangulation() const {
+	return triangulation;
+}
+
+void VGMeshRenderer::set_triangulation(Triangulation p_triangulation) {
+	triangulation = p_triangulation;
+	create_tesselator();
+	emit_changed();
+}
+
+VGMeshRenderer::Flattener VGMeshRenderer::get_flattener() const {
+	return flattener;
+}
+
+void VGMeshRenderer::set_flattener(Flattener p_flattener) {
+	flattener = p_flattener;
+	create_tesselator();
+	emit_changed();
+}
+
 void VGMeshRenderer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_quality", "quality"), &VGMeshRenderer::set_quality);
 	ClassDB::bind_method(D_METHOD("get_quality"), &VGMeshRenderer::get_quality);
 
+	ClassDB::bind_method(D_METHOD("set_triangulation", "triangulation"), &VGMeshRenderer::set_triangulation);
+	ClassDB::bind_method(D_METHOD("get_triangulation"), &VGMeshRenderer::get_triangulation);
+
+	ClassDB::bind_method(D_METHOD("set_flattener", "flattener"), &VGMeshRenderer::set_flattener);
+	ClassDB::bind_method(D_METHOD("get_flattener"), &VGMeshRenderer::get_flattener);
+
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "quality", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_quality", "get_quality");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "triangulation", PROPERTY_HINT_ENUM, "Ear Clipping,Monotone"), "set_triangulation", "get_triangulation");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "flattener", PROPERTY_HINT_ENUM, "Recursive,Wang,AntiGrain"), "set_flattener", "get_flattener");
+
+	BIND_ENUM_CONSTANT(TRIANGULATION_EAR_CLIPPING);
+	BIND_ENUM_CONSTANT(TRIANGULATION_MONOTONE);
+
+	BIND_ENUM_CONSTANT(FLATTENER_RECURSIVE);
+	BIND_ENUM_CONSTANT(FLATTENER_WANG);
+	BIND_ENUM_CONSTANT(FLATTENER_ANTIGRAIN);
 }
@@ -8,9 +8,26 @@
 #include "vector_graphics_mesh_renderer.h"
 
 class VGMeshRenderer : public VGAbstractMeshRenderer {
-	GDCLASS(VGMeshRenderer, VGRenderer);
+	GDCLASS(VGMeshRenderer, VGAbstractMeshRenderer);
 
+public:
+	enum Triangulation {
+		TRIANGULATION_EAR_CLIPPING,
+		TRIANGULATION_MONOTONE,
+	};
+
+	enum Flattener {
+		FLATTENER_RECURSIVE,
+		FLATTENER_WANG,
+		FLATTENER_ANTIGRAIN,
+	};
+
+private:
 	float quality;
+	Triangulation triangulation;
+	Flattener flattener;
+
+	tove::TesselatorRef make_tesselator(tove::ParallelExecutor *p_executor) const;
 
 protected:
 	void create_tesselator();
@@ -20,8 +37,19 @@ protected:
 public:
 	VGMeshRenderer();
 
+	virtual tove::TesselatorRef new_tesselator() const override;
+
 	float get_quality();
 	void set_quality(float p_quality);
+
+	Triangulation get_triangulation() const;
+	void set_triangulation(Triangulation p_triangulation);
+
+	Flattener get_flattener() const;
+	void set_flattener(Flattener p_flattener);
 };
 
+VARIANT_ENUM_CAST(VGMeshRenderer::Triangulation);
+VARIANT_ENUM_CAST(VGMeshRenderer::Flattener);
+
 #endif // VG_ADAPTIVE_RENDERER_H
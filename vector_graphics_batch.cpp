@@ -0,0 +1,37 @@
+/*************************************************************************/
+/*  vg_batch.cpp                                                         */
+/*************************************************************************/
+
+#include "vector_graphics_batch.h"
+
+VGBatch::VGBatch() {
+	mesh.instantiate();
+}
+
+void VGBatch::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_DRAW: {
+			const Size2 s = get_global_transform().get_scale();
+			path_count = VGAbstractMeshRenderer::render_batch(mesh, this, mesh_cache, buffers, MAX(s.width, s.height));
+			if (mesh->get_surface_count() > 0) {
+				draw_mesh(mesh, Ref<Texture2D>(), Transform2D());
+			}
+			if (mesh_cache.has_pending_jobs()) {
+				// look for the results again next frame.
+				set_process_internal(true);
+			}
+		} break;
+		case NOTIFICATION_INTERNAL_PROCESS: {
+			set_process_internal(false);
+			queue_redraw();
+		} break;
+	}
+}
+
+int VGBatch::get_batched_path_count() const {
+	return path_count;
+}
+
+void VGBatch::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_batched_path_count"), &VGBatch::get_batched_path_count);
+}
@@ -0,0 +1,33 @@
+/*************************************************************************/
+/*  vg_batch.h                                                           */
+/*************************************************************************/
+
+#ifndef VG_BATCH_H
+#define VG_BATCH_H
+
+#include "scene/2d/node_2d.h"
+#include "vector_graphics_mesh_renderer.h"
+
+// draws every VGPath below it that renders with a mesh renderer as one
+// vertex-colored mesh in a single draw call. the paths stop drawing
+// themselves and only tell the batch when they change; it then re-splices
+// their cached tessellations and patches the ranges that moved.
+class VGBatch : public Node2D {
+	GDCLASS(VGBatch, Node2D);
+
+	Ref<ArrayMesh> mesh;
+	VGMeshCache mesh_cache;
+	VGMeshBuffers buffers;
+	int path_count = 0;
+
+protected:
+	void _notification(int p_what);
+	static void _bind_methods();
+
+public:
+	int get_batched_path_count() const;
+
+	VGBatch();
+};
+
+#endif // VG_BATCH_H
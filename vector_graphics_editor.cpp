@@ -1549,7 +1549,7 @@ void VGEditor::_update_overlay(bool p_always_update) {
 		tove::TesselatorRef tesselator = tove::tove_make_shared<tove::AdaptiveTesselator>(
 				new tove::AdaptiveFlattener<tove::DefaultCurveFlattener>(
 						tove::DefaultCurveFlattener(100, 6)));
-		tove::MeshRef tove_mesh = tove::tove_make_shared<tove::ColorMesh>();
+		tove::MeshRef tove_mesh = tove::tove_make_shared<tove::ColorMesh>(tove::VERTEX_LAYOUT_SPLIT);
 		tesselator->graphicsToMesh(overlay_graphics.get(), UPDATE_MESH_EVERYTHING, tove_mesh, tove_mesh);
 		Ref<Texture> ignored_texture;
 		copy_mesh(overlay, tove_mesh, overlay_graphics, ignored_texture);
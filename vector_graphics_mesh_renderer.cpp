@@ -3,32 +3,47 @@
 /*************************************************************************/
 
 #include "vector_graphics_mesh_renderer.h"
+#include "core/config/engine.h"
 #include "modules/svg_mesh/thirdparty/tove2d/src/cpp/mesh/meshifier.h"
+#include "servers/rendering_server.h"
+#include "vector_graphics_batch.h"
 #include "vector_graphics_path.h"
 
 class Renderer {
-	int fill_index;
-	int line_index;
-
-	tove::MeshRef tove_mesh;
+protected:
 	tove::GraphicsRef root_graphics;
 
+	virtual void render_path(VGPath *p_path, VGAbstractMeshRenderer *p_renderer, const tove::TesselatorRef &p_tesselator, const Transform2D &p_transform) = 0;
+
 public:
-	Renderer(const tove::MeshRef &p_tove_mesh, const tove::GraphicsRef &p_root_graphics) {
-		fill_index = 0;
-		line_index = 0;
-		tove_mesh = p_tove_mesh;
+	Renderer(const tove::GraphicsRef &p_root_graphics) {
 		root_graphics = p_root_graphics;
 	}
 
+	virtual ~Renderer() {
+	}
+
+	// batches stand in for their paths' canvas items, so they have to leave
+	// out what those would not have drawn, and the paths that draw
+	// themselves.
+	bool batching = false;
+
 	void traverse(Node *p_node, const Transform2D &p_transform) {
 		const int n = p_node->get_child_count();
 		for (int i = 0; i < n; i++) {
 			Node *child = p_node->get_child(i);
+			if (child->is_class_ptr(VGBatch::get_class_ptr_static())) {
+				// batches draw their paths themselves.
+				continue;
+			}
 
 			Transform2D t;
 			if (child->is_class_ptr(CanvasItem::get_class_ptr_static())) {
-				t = p_transform * Object::cast_to<CanvasItem>(child)->get_transform();
+				const CanvasItem *item = Object::cast_to<CanvasItem>(child);
+				if (batching && !item->is_visible()) {
+					continue;
+				}
+				t = p_transform * item->get_transform();
 			} else {
 				t = p_transform;
 			}
@@ -38,53 +53,837 @@ public:
 
 		if (p_node->is_class_ptr(VGPath::get_class_ptr_static())) {
 			VGPath *path = Object::cast_to<VGPath>(p_node);
+			if (batching && !path->is_batched()) {
+				return;
+			}
 			Ref<VGRenderer> renderer = path->get_inherited_renderer();
 			if (renderer.is_valid() && renderer->is_class_ptr(VGAbstractMeshRenderer::get_class_ptr_static())) {
 				Ref<VGAbstractMeshRenderer> meshRenderer = Object::cast_to<VGAbstractMeshRenderer>(renderer.ptr());
 				if (meshRenderer.is_valid()) {
 					tove::TesselatorRef tesselator = meshRenderer->get_tesselator();
 					if (tesselator) {
-						Size2 s = path->get_global_transform().get_scale();
-						tesselator->beginTesselate(root_graphics.get(), MAX(s.width, s.height));
+						render_path(path, meshRenderer.ptr(), tesselator, p_transform);
+					}
+				}
+			}
+		}
+	}
+};
 
-						tesselator->pathToMesh(
-								UPDATE_MESH_EVERYTHING,
-								new_transformed_path(path->get_tove_path(), p_transform),
-								tove_mesh, tove_mesh,
-								fill_index, line_index);
+// tessellates the whole subtree into one tove mesh.
+class MeshRenderer : public Renderer {
+	int fill_index;
+	int line_index;
 
-						tesselator->endTesselate();
-					}
+	tove::MeshRef tove_mesh;
+
+protected:
+	virtual void render_path(VGPath *p_path, VGAbstractMeshRenderer *p_renderer, const tove::TesselatorRef &p_tesselator, const Transform2D &p_transform) override {
+		Size2 s = p_path->get_global_transform().get_scale();
+		VGAbstractMeshRenderer::tesselate_path(
+				p_tesselator, root_graphics,
+				new_transformed_path(p_path->get_tove_path(), p_transform),
+				MAX(s.width, s.height),
+				tove_mesh, fill_index, line_index);
+	}
+
+public:
+	MeshRenderer(const tove::MeshRef &p_tove_mesh, const tove::GraphicsRef &p_root_graphics) :
+			Renderer(p_root_graphics) {
+		fill_index = 0;
+		line_index = 0;
+		tove_mesh = p_tove_mesh;
+	}
+};
+
+// tessellates each path into its own cache entry and only redoes the ones
+// whose version changed or that have no level for their current bucket.
+class CachedRenderer : public Renderer {
+	struct Splice {
+		const VGMeshCache::Level *level;
+		Transform2D transform;
+	};
+
+	VGMeshCache &cache;
+
+	// async renders keep stale levels to draw while their replacement is
+	// tessellated; the lod cache size still bounds them.
+	static VGMeshCache::Level *find_level(VGMeshCache::Entry *p_entry, uint64_t p_version, bool p_keep_stale = false) {
+		uint32_t i = 0;
+		while (!p_keep_stale && i < p_entry->levels.size()) {
+			if (p_entry->levels[i].version != p_version) {
+				// versions only grow, so these will never match again.
+				p_entry->levels.remove_at_unordered(i);
+			} else {
+				i++;
+			}
+		}
+		for (VGMeshCache::Level &level : p_entry->levels) {
+			if (level.version == p_version && level.bucket == p_entry->bucket) {
+				return &level;
+			}
+		}
+		return nullptr;
+	}
+
+	// repaints a level with the path's current paints. positions only go
+	// back into the tove mesh if a gradient needs to be evaluated at them.
+	static void recolor_level(VGMeshCache::Level *p_level, const tove::PathRef &p_tove_path, VGAbstractMeshRenderer *p_renderer) {
+		const tove::MeshRef &tove_mesh = p_renderer->acquire_mesh(false);
+		const int n = p_level->vertices.size();
+		tove::Vertices v = tove_mesh->vertices(0, n);
+
+		const NSVGshape *shape = p_tove_path->getNSVG();
+		if (shape->fill.type >= NSVG_PAINT_LINEAR_GRADIENT || shape->stroke.type >= NSVG_PAINT_LINEAR_GRADIENT) {
+			for (int i = 0; i < n; i++) {
+				v[i].x = p_level->vertices[i].x * 1000.0f;
+				v[i].y = p_level->vertices[i].y * -1000.0f;
+			}
+		}
+
+		for (const tove::PaintRange &range : p_level->paint_ranges) {
+			if (range.line) {
+				tove_mesh->setLineColor(p_tove_path, range.vertexIndex, range.vertexCount);
+			} else {
+				tove_mesh->setFillColor(p_tove_path, range.vertexIndex, range.vertexCount);
+			}
+		}
+
+		if (n > 0) {
+			copy_mesh_colors(tove_mesh, p_level->colors.ptr());
+		}
+		p_level->color_hash = hash_murmur3_buffer(p_level->colors.ptr(), n * sizeof(Color));
+	}
+
+	// the level drawn while its replacement is tessellated: the one drawn
+	// last, or the newest of those.
+	static VGMeshCache::Level *find_fallback_level(VGMeshCache::Entry *p_entry) {
+		VGMeshCache::Level *fallback = nullptr;
+		for (VGMeshCache::Level &level : p_entry->levels) {
+			if (!fallback || level.used > fallback->used ||
+					(level.used == fallback->used && level.version > fallback->version)) {
+				fallback = &level;
+			}
+		}
+		return fallback;
+	}
+
+	static void evict_lru_level(VGMeshCache::Entry *p_entry) {
+		uint32_t lru = 0;
+		for (uint32_t i = 1; i < p_entry->levels.size(); i++) {
+			if (p_entry->levels[i].used < p_entry->levels[lru].used) {
+				lru = i;
+			}
+		}
+		p_entry->levels.remove_at_unordered(lru);
+	}
+
+	// makes room for one more level within the renderer's lod cache size.
+	static VGMeshCache::Level *add_level(VGMeshCache::Entry *p_entry, int p_capacity) {
+		while (p_entry->levels.size() > 0 && int(p_entry->levels.size()) >= p_capacity) {
+			evict_lru_level(p_entry);
+		}
+		p_entry->levels.push_back(VGMeshCache::Level());
+		return &p_entry->levels[p_entry->levels.size() - 1];
+	}
+
+	static void store_level(VGMeshCache::Level *r_level, const tove::MeshRef &p_tove_mesh) {
+		const int vertex_count = p_tove_mesh->getVertexCount();
+		r_level->vertices.resize(vertex_count);
+		r_level->colors.resize(vertex_count);
+		r_level->indices.resize(p_tove_mesh->getIndexCount());
+		if (vertex_count > 0) {
+			copy_mesh_vertices(p_tove_mesh, Vector3(), r_level->vertices.ptr(), r_level->colors.ptr());
+			copy_mesh_indices(p_tove_mesh, 0, r_level->indices.ptr());
+		}
+		r_level->vertex_hash = hash_murmur3_buffer(r_level->vertices.ptr(), vertex_count * sizeof(Vector3));
+		r_level->color_hash = hash_murmur3_buffer(r_level->colors.ptr(), vertex_count * sizeof(Color));
+		r_level->index_hash = hash_murmur3_buffer(r_level->indices.ptr(), r_level->indices.size() * sizeof(int32_t));
+
+		const std::vector<tove::PaintRange> &paint_ranges = p_tove_mesh->getPaintRanges();
+		r_level->paint_ranges.resize(paint_ranges.size());
+		for (uint32_t i = 0; i < paint_ranges.size(); i++) {
+			r_level->paint_ranges[i] = paint_ranges[i];
+		}
+	}
+
+	// runs on a worker thread.
+	static void run_job(void *p_job) {
+		VGMeshCache::Job *job = static_cast<VGMeshCache::Job *>(p_job);
+		const tove::MeshRef tove_mesh = tove::tove_make_shared<tove::ColorMesh>(tove::VERTEX_LAYOUT_SPLIT);
+		int fill_index = 0;
+		int line_index = 0;
+		VGAbstractMeshRenderer::tesselate_path(
+				job->tesselator, job->graphics, job->tove_path, job->scale,
+				tove_mesh, fill_index, line_index);
+		store_level(&job->level, tove_mesh);
+	}
+
+	// snapshots the path and its clips as they are now, for the entry's
+	// current bucket, so that the job reads nothing the scene still owns.
+	void start_job(const ObjectID &p_id, const VGMeshCache::Entry *p_entry, VGPath *p_path, VGAbstractMeshRenderer *p_renderer) {
+		VGMeshCache::Job *job = memnew(VGMeshCache::Job);
+		job->tove_path = new_transformed_path(p_path->get_tove_path(), Transform2D());
+		job->graphics = new_clip_graphics(root_graphics);
+		job->tesselator = p_renderer->new_tesselator();
+		job->scale = VGAbstractMeshRenderer::get_lod_bucket_scale(p_entry->bucket);
+		job->level.bucket = p_entry->bucket;
+		job->level.version = p_path->get_version();
+		job->level.color_version = p_path->get_color_version();
+		cache.jobs.insert(p_id, job);
+		job->task = WorkerThreadPool::get_singleton()->add_native_task(
+				&CachedRenderer::run_job, job, false, SNAME("VGTesselate"));
+	}
+
+	// the async counterpart of tessellating a missing level: takes a
+	// finished job's level if the frame's budget allows, and otherwise
+	// starts a job (unless one is running) and falls back to the level that
+	// was drawn before. a result that is already outdated still replaces
+	// the fallback.
+	VGMeshCache::Level *find_async_level(const ObjectID &p_id, VGMeshCache::Entry *p_entry, VGPath *p_path, VGAbstractMeshRenderer *p_renderer) {
+		VGMeshCache::Job **job = cache.jobs.getptr(p_id);
+		if (job && WorkerThreadPool::get_singleton()->is_task_completed((*job)->task) && p_renderer->take_async_result()) {
+			VGMeshCache::Level *level = add_level(p_entry, p_renderer->get_lod_cache_size());
+			*level = (*job)->level;
+			level->used = cache.pass;
+			cache.finish_job(p_id);
+			job = nullptr;
+		}
+
+		VGMeshCache::Level *level = find_level(p_entry, p_path->get_version(), true);
+		if (level) {
+			return level;
+		}
+		if (!job) {
+			start_job(p_id, p_entry, p_path, p_renderer);
+		}
+		return find_fallback_level(p_entry);
+	}
+
+	// everything a rigid tessellation's vertex layout depends on.
+	static uint32_t hash_rigid_topology(const tove::PathRef &p_path) {
+		const NSVGshape *shape = p_path->getNSVG();
+		uint32_t h = hash_murmur3_one_32(p_path->getIndex());
+		h = hash_murmur3_one_32(shape->fill.type, h);
+		h = hash_murmur3_one_32(shape->stroke.type, h);
+		h = hash_murmur3_one_32(p_path->hasStroke(), h);
+		h = hash_murmur3_one_32(p_path->getLineJoin() == TOVE_LINEJOIN_MITER && p_path->getMiterLimit() > 0.0f, h);
+		const int n = p_path->getNumSubpaths();
+		for (int i = 0; i < n; i++) {
+			const NSVGpath &subpath = p_path->getSubpath(i)->nsvg;
+			h = hash_murmur3_one_32(subpath.npts, h);
+			h = hash_murmur3_one_32(subpath.closed, h);
+		}
+		return hash_fmix32(h);
+	}
+
+	// the entry's own mesh, with the update that keeps its triangulations
+	// if the topology is the one they were made for.
+	static const tove::MeshRef &acquire_rigid_mesh(VGMeshCache::Entry *p_entry, const tove::TesselatorRef &p_tesselator, const tove::PathRef &p_path, ToveMeshUpdateFlags &r_update) {
+		const uint32_t topology = hash_rigid_topology(p_path);
+		if (p_entry->rigid_mesh && p_entry->rigid_tesselator == p_tesselator && p_entry->rigid_topology == topology) {
+			r_update = UPDATE_MESH_VERTICES | UPDATE_MESH_COLORS | UPDATE_MESH_AUTO_TRIANGLES;
+		} else {
+			p_entry->rigid_mesh = tove::tove_make_shared<tove::ColorMesh>(tove::VERTEX_LAYOUT_SPLIT);
+			p_entry->rigid_tesselator = p_tesselator;
+			p_entry->rigid_topology = topology;
+			r_update = UPDATE_MESH_EVERYTHING;
+		}
+		return p_entry->rigid_mesh;
+	}
+
+	// a splice transform, expressed in mesh units (y up, 1/1000).
+	static Transform2D to_mesh_units(const Transform2D &p_transform) {
+		const Transform2D &t = p_transform;
+		return Transform2D(t.columns[0].x, -t.columns[0].y, -t.columns[1].x, t.columns[1].y,
+				t.columns[2].x * 0.001f, t.columns[2].y * -0.001f);
+	}
+
+	static void splice_vertices(const Splice &p_splice, Vector3 *r_vertices) {
+		const VGMeshCache::Level *level = p_splice.level;
+		const uint32_t n = level->vertices.size();
+		if (p_splice.transform == Transform2D()) {
+			memcpy(r_vertices, level->vertices.ptr(), n * sizeof(Vector3));
+		} else {
+			const Transform2D m_t = to_mesh_units(p_splice.transform);
+			for (uint32_t i = 0; i < n; i++) {
+				const Vector3 &v = level->vertices[i];
+				const Vector2 p = m_t.xform(Vector2(v.x, v.y));
+				r_vertices[i] = Vector3(p.x, p.y, v.z);
+			}
+		}
+	}
+
+	// append a splice's positions or colors, as the server stores them, to a
+	// run; the region always holds exactly the run.
+	static void append_positions(const Splice &p_splice, Vector<uint8_t> &r_region, uint32_t &r_run, AABB &r_bounds, VGMeshBuffers &r_buffers) {
+		const VGMeshCache::Level *level = p_splice.level;
+		const uint32_t n = level->vertices.size();
+		ERR_FAIL_COND(r_buffers.resize_buffer(r_region, (r_run + n) * 3 * sizeof(float)) != OK);
+		float *w = reinterpret_cast<float *>(r_region.ptrw()) + r_run * 3;
+		const Transform2D m_t = to_mesh_units(p_splice.transform);
+		for (uint32_t i = 0; i < n; i++) {
+			const Vector3 &v = level->vertices[i];
+			const Vector2 p = m_t.xform(Vector2(v.x, v.y));
+			r_bounds.expand_to(Vector3(p.x, p.y, v.z));
+			w[i * 3 + 0] = p.x;
+			w[i * 3 + 1] = p.y;
+			w[i * 3 + 2] = v.z;
+		}
+		r_run += n;
+	}
+
+	static void append_colors(const Splice &p_splice, Vector<uint8_t> &r_region, uint32_t &r_run, VGMeshBuffers &r_buffers) {
+		const uint32_t n = p_splice.level->colors.size();
+		ERR_FAIL_COND(r_buffers.resize_buffer(r_region, (r_run + n) * 4) != OK);
+		uint8_t *w = r_region.ptrw() + r_run * 4;
+		for (uint32_t i = 0; i < n; i++) {
+			encode_mesh_color(p_splice.level->colors[i], w + i * 4);
+		}
+		r_run += n;
+	}
+
+protected:
+	virtual void render_path(VGPath *p_path, VGAbstractMeshRenderer *p_renderer, const tove::TesselatorRef &p_tesselator, const Transform2D &p_transform) override {
+		const ObjectID id = p_path->get_instance_id();
+		VGMeshCache::Entry *entry = cache.entries.getptr(id);
+		if (!entry) {
+			entry = &cache.entries.insert(id, VGMeshCache::Entry())->value;
+		}
+
+		const bool rigid = p_tesselator->hasFixedSize();
+		if (rigid) {
+			// the tessellation doesn't depend on scale.
+			entry->bucket = 0;
+		} else {
+			const Size2 s = p_path->get_global_transform().get_scale();
+			entry->bucket = VGAbstractMeshRenderer::select_lod_bucket(MAX(s.width, s.height), entry->bucket);
+		}
+
+		const uint64_t version = p_path->get_version();
+		const uint64_t color_version = p_path->get_color_version();
+		const bool async = p_renderer->is_async_tessellation_enabled();
+		if (!async && cache.has_pending_jobs()) {
+			// async was turned off meanwhile.
+			cache.finish_job(id);
+		}
+		VGMeshCache::Level *level = find_level(entry, version, async);
+		p_renderer->record_lod_cache_lookup(level != nullptr);
+		if (!level && async) {
+			level = find_async_level(id, entry, p_path, p_renderer);
+			if (!level) {
+				// nothing to draw until the first tessellation arrives.
+				entry->pass = cache.pass;
+				return;
+			}
+		}
+
+		if (level && level->color_version != color_version) {
+			// only paints changed; the tessellation stays.
+			recolor_level(level, p_path->get_tove_path(), p_renderer);
+			level->color_version = color_version;
+		}
+
+		if (!level) {
+			level = add_level(entry, p_renderer->get_lod_cache_size());
+
+			const tove::PathRef &tove_path = p_path->get_tove_path();
+			ToveMeshUpdateFlags update = UPDATE_MESH_EVERYTHING;
+			const tove::MeshRef &tove_mesh = rigid ? acquire_rigid_mesh(entry, p_tesselator, tove_path, update) : p_renderer->acquire_mesh(false);
+			int fill_index = 0;
+			int line_index = 0;
+			tove_mesh->clearPaintRanges();
+			VGAbstractMeshRenderer::tesselate_path(
+					p_tesselator, root_graphics,
+					tove_path,
+					VGAbstractMeshRenderer::get_lod_bucket_scale(entry->bucket),
+					tove_mesh, fill_index, line_index, update);
+
+			store_level(level, tove_mesh);
+
+			level->bucket = entry->bucket;
+			level->version = version;
+			level->color_version = color_version;
+		}
+
+		level->used = cache.pass;
+		entry->pass = cache.pass;
+
+		Splice splice;
+		splice.level = level;
+		splice.transform = p_transform;
+		order.push_back(splice);
+	}
+
+public:
+	LocalVector<Splice> order;
+
+	CachedRenderer(VGMeshCache &p_cache, const tove::GraphicsRef &p_root_graphics, float p_scale) :
+			Renderer(p_root_graphics), cache(p_cache) {
+		cache.pass++;
+		cache.bucket = VGAbstractMeshRenderer::select_lod_bucket(p_scale, cache.bucket);
+	}
+
+	// splices the cached ranges together in traversal order.
+	void copy_to(Ref<ArrayMesh> &p_mesh, VGMeshBuffers &r_buffers) {
+		cache.uploads.clear();
+		cache.mesh = RID();
+
+		uint32_t vertex_count = 0;
+		uint32_t index_count = 0;
+		for (const Splice &splice : order) {
+			vertex_count += splice.level->vertices.size();
+			index_count += splice.level->indices.size();
+		}
+		if (vertex_count == 0) {
+			return;
+		}
+
+		ERR_FAIL_COND(r_buffers.resize(vertex_count, index_count) != OK);
+
+		Vector3 *w_vertices = r_buffers.vertices.ptrw();
+		Color *w_colors = r_buffers.colors.ptrw();
+		int *w_indices = r_buffers.indices.ptrw();
+		uint32_t vertex_base = 0;
+		uint32_t index_base = 0;
+
+		for (const Splice &splice : order) {
+			const VGMeshCache::Level *level = splice.level;
+			const uint32_t n = level->vertices.size();
+			const uint32_t m = level->indices.size();
+			splice_vertices(splice, w_vertices + vertex_base);
+			memcpy(w_colors + vertex_base, level->colors.ptr(), n * sizeof(Color));
+			for (uint32_t i = 0; i < m; i++) {
+				w_indices[index_base + i] = vertex_base + level->indices[i];
+			}
+			vertex_base += n;
+			index_base += m;
+		}
+
+		Array arr;
+		ERR_FAIL_COND(arr.resize(Mesh::ARRAY_MAX) != OK);
+		arr[Mesh::ARRAY_VERTEX] = r_buffers.vertices;
+		arr[Mesh::ARRAY_NORMAL] = r_buffers.normals;
+		arr[Mesh::ARRAY_TANGENT] = r_buffers.tangents;
+		arr[Mesh::ARRAY_COLOR] = r_buffers.colors;
+		arr[Mesh::ARRAY_INDEX] = r_buffers.indices;
+
+		if (p_mesh->get_custom_aabb() != AABB()) {
+			// left over from partial updates.
+			p_mesh->set_custom_aabb(AABB());
+		}
+		p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr);
+		record_uploads(p_mesh);
+	}
+
+	// rewrites, in place, the vertex and color ranges of paths that changed
+	// since the last upload into p_mesh. fails without touching the mesh if
+	// anything else (counts, indices, order) is different.
+	bool patch(const Ref<ArrayMesh> &p_mesh, VGMeshBuffers &r_buffers) {
+		if (p_mesh.is_null() || p_mesh->get_rid() != cache.mesh ||
+				p_mesh->get_surface_count() != 1 || cache.uploads.size() != order.size()) {
+			return false;
+		}
+		int vertex_count = 0;
+		int index_count = 0;
+		for (uint32_t i = 0; i < order.size(); i++) {
+			const VGMeshCache::Upload &upload = cache.uploads[i];
+			const VGMeshCache::Level *level = order[i].level;
+			if (upload.vertex_count != level->vertices.size() ||
+					upload.index_count != level->indices.size() ||
+					upload.index_hash != level->index_hash) {
+				return false;
+			}
+			vertex_count += upload.vertex_count;
+			index_count += upload.index_count;
+		}
+		if (vertex_count == 0 ||
+				p_mesh->surface_get_array_len(0) != vertex_count ||
+				p_mesh->surface_get_array_index_len(0) != index_count) {
+			return false;
+		}
+
+		// runs are written as packed positions and colors, so those must
+		// be the only thing in their streams.
+		uint32_t offsets[RS::ARRAY_MAX];
+		uint32_t vertex_stride;
+		uint32_t normal_stride;
+		uint32_t attribute_stride;
+		uint32_t skin_stride;
+		RS::get_singleton()->mesh_surface_make_offsets_from_format(
+				uint64_t(p_mesh->surface_get_format(0)),
+				vertex_count, index_count,
+				offsets, vertex_stride, normal_stride, attribute_stride, skin_stride);
+		if (vertex_stride != 3 * sizeof(float) || attribute_stride != 4) {
+			return false;
+		}
+
+		// the surface's aabb is from the last full upload.
+		AABB bounds = p_mesh->get_custom_aabb() != AABB() ? p_mesh->get_custom_aabb() : p_mesh->get_aabb();
+		bool moved_any = false;
+		uint32_t vertex_base = 0;
+		uint32_t position_start = 0;
+		uint32_t position_run = 0;
+		uint32_t color_start = 0;
+		uint32_t color_run = 0;
+
+		for (uint32_t i = 0; i <= order.size(); i++) {
+			bool moved = false;
+			bool recolored = false;
+			if (i < order.size()) {
+				const VGMeshCache::Upload &upload = cache.uploads[i];
+				const VGMeshCache::Level *level = order[i].level;
+				moved = upload.vertex_hash != level->vertex_hash || upload.transform != order[i].transform;
+				recolored = upload.color_hash != level->color_hash;
+			}
+
+			if (moved) {
+				if (position_run == 0) {
+					position_start = vertex_base;
+				}
+				append_positions(order[i], r_buffers.vertex_region, position_run, bounds, r_buffers);
+				moved_any = true;
+			} else if (position_run > 0) {
+				p_mesh->surface_update_vertex_region(0, position_start * vertex_stride, r_buffers.vertex_region);
+				position_run = 0;
+			}
+
+			if (recolored) {
+				if (color_run == 0) {
+					color_start = vertex_base;
 				}
+				append_colors(order[i], r_buffers.color_region, color_run, r_buffers);
+			} else if (color_run > 0) {
+				p_mesh->surface_update_attribute_region(0, color_start * attribute_stride, r_buffers.color_region);
+				color_run = 0;
+			}
+
+			if (i < order.size()) {
+				vertex_base += order[i].level->vertices.size();
+			}
+		}
+
+		if (moved_any) {
+			// grow only; the exact box would need every vertex.
+			p_mesh->set_custom_aabb(bounds);
+		}
+
+		record_uploads(p_mesh);
+		return true;
+	}
+
+	void record_uploads(const Ref<ArrayMesh> &p_mesh) {
+		cache.uploads.resize(order.size());
+		for (uint32_t i = 0; i < order.size(); i++) {
+			const VGMeshCache::Level *level = order[i].level;
+			VGMeshCache::Upload &upload = cache.uploads[i];
+			upload.vertex_count = level->vertices.size();
+			upload.index_count = level->indices.size();
+			upload.vertex_hash = level->vertex_hash;
+			upload.color_hash = level->color_hash;
+			upload.index_hash = level->index_hash;
+			upload.transform = order[i].transform;
+		}
+		cache.mesh = p_mesh->get_rid();
+	}
+
+	// drops the entries of paths that have left the subtree.
+	void evict() {
+		LocalVector<ObjectID> stale;
+		for (const KeyValue<ObjectID, VGMeshCache::Entry> &E : cache.entries) {
+			if (E.value.pass != cache.pass) {
+				stale.push_back(E.key);
 			}
 		}
+		for (const ObjectID &id : stale) {
+			cache.finish_job(id);
+			cache.entries.erase(id);
+		}
 	}
 };
 
+Error VGMeshBuffers::resize(int p_vertex_count, int p_index_count) {
+	const int filled = MIN(normals.size(), p_vertex_count);
+
+	ERR_FAIL_COND_V(resize_buffer(vertices, p_vertex_count) != OK, ERR_OUT_OF_MEMORY);
+	ERR_FAIL_COND_V(resize_buffer(colors, p_vertex_count) != OK, ERR_OUT_OF_MEMORY);
+	ERR_FAIL_COND_V(resize_buffer(indices, p_index_count) != OK, ERR_OUT_OF_MEMORY);
+	ERR_FAIL_COND_V(resize_buffer(normals, p_vertex_count) != OK, ERR_OUT_OF_MEMORY);
+	ERR_FAIL_COND_V(resize_buffer(tangents, p_vertex_count * 4) != OK, ERR_OUT_OF_MEMORY);
+
+	// normals and tangents are the same for every vertex (see
+	// add_planar_normals()), so only grown entries need writing.
+	Vector3 *w_normals = normals.ptrw();
+	float *w_tangents = tangents.ptrw();
+	for (int i = filled; i < p_vertex_count; i++) {
+		w_normals[i] = Vector3(0, 0, 1);
+		w_tangents[i * 4 + 0] = 1.0f;
+		w_tangents[i * 4 + 1] = 0.0f;
+		w_tangents[i * 4 + 2] = 0.0f;
+		w_tangents[i * 4 + 3] = 1.0f;
+	}
+
+	return OK;
+}
+
+void VGMeshCache::finish_job(const ObjectID &p_id) {
+	Job **job = jobs.getptr(p_id);
+	if (!job) {
+		return;
+	}
+	WorkerThreadPool::get_singleton()->wait_for_task_completion((*job)->task);
+	memdelete(*job);
+	jobs.erase(p_id);
+}
+
+VGMeshCache::~VGMeshCache() {
+	while (!jobs.is_empty()) {
+		finish_job(jobs.begin()->key);
+	}
+}
+
+void VGMeshBuffers::clear() {
+	vertices.clear();
+	colors.clear();
+	indices.clear();
+	normals.clear();
+	tangents.clear();
+	vertex_region.clear();
+	color_region.clear();
+}
+
 VGAbstractMeshRenderer::VGAbstractMeshRenderer() {
 }
 
-Rect2 VGAbstractMeshRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) {
+const tove::MeshRef &VGAbstractMeshRenderer::acquire_mesh(bool p_paint) {
+	tove::MeshRef &mesh = p_paint ? paint_mesh : color_mesh;
+	mesh_acquired = true;
+	if (!mesh) {
+		if (p_paint) {
+			mesh = tove::tove_make_shared<tove::PaintMesh>(tove::VERTEX_LAYOUT_SPLIT);
+		} else {
+			mesh = tove::tove_make_shared<tove::ColorMesh>(tove::VERTEX_LAYOUT_SPLIT);
+		}
+	} else {
+		mesh_peak = MAX(mesh_peak, mesh->getVertexCount());
+		mesh->recycle();
+	}
+	return mesh;
+}
 
-	clear_mesh(p_mesh);
+void VGAbstractMeshRenderer::shrink_mesh(const tove::MeshRef &p_mesh) {
+	if (!mesh_acquired) {
+		// every path came from the cache; the last size says nothing.
+		return;
+	}
+	mesh_acquired = false;
+	mesh_peak = MAX(mesh_peak, p_mesh->getVertexCount());
+	// small meshes aren't worth the churn.
+	if (p_mesh->getVertexCapacity() > MAX(4 * mesh_peak, 1024)) {
+		p_mesh->shrinkToFit();
+	}
+	mesh_peak = 0;
+}
+
+void VGAbstractMeshRenderer::shrink_buffers() {
+	if (color_mesh) {
+		color_mesh->recycle();
+		color_mesh->shrinkToFit();
+	}
+	if (paint_mesh) {
+		paint_mesh->recycle();
+		paint_mesh->shrinkToFit();
+	}
+	mesh_peak = 0;
+	mesh_acquired = false;
+	buffers.clear();
+}
+
+int64_t VGAbstractMeshRenderer::get_allocation_count() const {
+	uint64_t count = buffers.allocations;
+	if (color_mesh) {
+		count += color_mesh->getAllocationCount();
+	}
+	if (paint_mesh) {
+		count += paint_mesh->getAllocationCount();
+	}
+	return count;
+}
+
+bool VGAbstractMeshRenderer::is_partial_updates_enabled() const {
+	return partial_updates;
+}
+
+void VGAbstractMeshRenderer::set_partial_updates_enabled(bool p_enabled) {
+	partial_updates = p_enabled;
+}
+
+bool VGAbstractMeshRenderer::is_async_tessellation_enabled() const {
+	return async_tessellation;
+}
+
+void VGAbstractMeshRenderer::set_async_tessellation_enabled(bool p_enabled) {
+	async_tessellation = p_enabled;
+}
+
+int VGAbstractMeshRenderer::get_async_apply_budget() const {
+	return async_apply_budget;
+}
+
+void VGAbstractMeshRenderer::set_async_apply_budget(int p_budget) {
+	async_apply_budget = MAX(1, p_budget);
+}
+
+bool VGAbstractMeshRenderer::take_async_result() {
+	const uint64_t frame = Engine::get_singleton()->get_frames_drawn();
+	if (frame != async_frame) {
+		async_frame = frame;
+		async_applied = 0;
+	}
+	if (async_applied >= async_apply_budget) {
+		return false;
+	}
+	async_applied++;
+	return true;
+}
+
+int VGAbstractMeshRenderer::select_lod_bucket(float p_scale, int p_current_bucket) {
+	const float octave = Math::log2(MAX(p_scale, CMP_EPSILON));
+	if (p_current_bucket != VGMeshCache::NO_BUCKET && Math::abs(octave - p_current_bucket) <= 0.75f) {
+		return p_current_bucket;
+	}
+	return int(Math::round(octave));
+}
+
+float VGAbstractMeshRenderer::get_lod_bucket_scale(int p_bucket) {
+	return Math::pow(2.0f, float(p_bucket));
+}
+
+int VGAbstractMeshRenderer::get_lod_cache_size() const {
+	return lod_cache_size;
+}
+
+void VGAbstractMeshRenderer::set_lod_cache_size(int p_size) {
+	// only bounds how many levels each path keeps; excess ones are evicted
+	// on the next render, the output doesn't change.
+	lod_cache_size = MAX(1, p_size);
+}
+
+void VGAbstractMeshRenderer::record_lod_cache_lookup(bool p_hit) {
+	if (p_hit) {
+		lod_cache_hits++;
+	} else {
+		lod_cache_misses++;
+	}
+}
+
+float VGAbstractMeshRenderer::get_lod_cache_hit_rate() const {
+	const uint64_t lookups = lod_cache_hits + lod_cache_misses;
+	return lookups > 0 ? double(lod_cache_hits) / double(lookups) : 0.0;
+}
+
+void VGAbstractMeshRenderer::reset_lod_cache_stats() {
+	lod_cache_hits = 0;
+	lod_cache_misses = 0;
+}
+
+void VGAbstractMeshRenderer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_lod_cache_size", "size"), &VGAbstractMeshRenderer::set_lod_cache_size);
+	ClassDB::bind_method(D_METHOD("get_lod_cache_size"), &VGAbstractMeshRenderer::get_lod_cache_size);
+	ClassDB::bind_method(D_METHOD("get_lod_cache_hit_rate"), &VGAbstractMeshRenderer::get_lod_cache_hit_rate);
+	ClassDB::bind_method(D_METHOD("reset_lod_cache_stats"), &VGAbstractMeshRenderer::reset_lod_cache_stats);
+	ClassDB::bind_method(D_METHOD("shrink_buffers"), &VGAbstractMeshRenderer::shrink_buffers);
+	ClassDB::bind_method(D_METHOD("get_allocation_count"), &VGAbstractMeshRenderer::get_allocation_count);
+	ClassDB::bind_method(D_METHOD("set_partial_updates_enabled", "enabled"), &VGAbstractMeshRenderer::set_partial_updates_enabled);
+	ClassDB::bind_method(D_METHOD("is_partial_updates_enabled"), &VGAbstractMeshRenderer::is_partial_updates_enabled);
+	ClassDB::bind_method(D_METHOD("set_async_tessellation_enabled", "enabled"), &VGAbstractMeshRenderer::set_async_tessellation_enabled);
+	ClassDB::bind_method(D_METHOD("is_async_tessellation_enabled"), &VGAbstractMeshRenderer::is_async_tessellation_enabled);
+	ClassDB::bind_method(D_METHOD("set_async_apply_budget", "budget"), &VGAbstractMeshRenderer::set_async_apply_budget);
+	ClassDB::bind_method(D_METHOD("get_async_apply_budget"), &VGAbstractMeshRenderer::get_async_apply_budget);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_cache_size", PROPERTY_HINT_RANGE, "1,16,1"), "set_lod_cache_size", "get_lod_cache_size");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "partial_updates"), "set_partial_updates_enabled", "is_partial_updates_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "async_tessellation"), "set_async_tessellation_enabled", "is_async_tessellation_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "async_apply_budget", PROPERTY_HINT_RANGE, "1,256,1,or_greater"), "set_async_apply_budget", "get_async_apply_budget");
+}
+
+void VGAbstractMeshRenderer::tesselate_path(
+		const tove::TesselatorRef &p_tesselator,
+		const tove::GraphicsRef &p_graphics,
+		const tove::PathRef &p_tove_path,
+		float p_scale,
+		const tove::MeshRef &p_tove_mesh,
+		int &r_fill_index,
+		int &r_line_index,
+		ToveMeshUpdateFlags p_update) {
+
+	p_tesselator->beginTesselate(p_graphics.get(), p_scale);
+
+	p_tesselator->pathToMesh(
+			p_update,
+			p_tove_path,
+			p_tove_mesh, p_tove_mesh,
+			r_fill_index, r_line_index);
+
+	p_tesselator->endTesselate();
+}
+
+Rect2 VGAbstractMeshRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) {
 
 	VGPath *root = p_path->get_root_path();
 	tove::GraphicsRef subtree_graphics = root->get_subtree_graphics();
 
-	tove::MeshRef tove_mesh;
-
 	if (p_hq && !subtree_graphics->areColorsSolid()) {
-		tove_mesh = tove::tove_make_shared<tove::PaintMesh>();
+		clear_mesh(p_mesh);
+
+		// whatever was uploaded into p_mesh before is gone.
+		VGMeshCache &cache = p_path->get_mesh_cache();
+		cache.uploads.clear();
+		cache.mesh = RID();
+
+		// paint indices and the gradient shader span the whole subtree, so
+		// there is nothing to reuse per path here.
+		tove::MeshRef tove_mesh = acquire_mesh(true);
+
+		MeshRenderer r(tove_mesh, subtree_graphics);
+		r.traverse(p_path, Transform2D());
+
+		r_material = copy_mesh(p_mesh, tove_mesh, subtree_graphics, r_texture, p_spatial);
+		shrink_mesh(tove_mesh);
 	} else {
-		tove_mesh = tove::tove_make_shared<tove::ColorMesh>();
+		const Size2 s = p_path->get_global_transform().get_scale();
+		CachedRenderer r(p_path->get_mesh_cache(), subtree_graphics, MAX(s.width, s.height));
+		r.traverse(p_path, Transform2D());
+		if (!partial_updates || !r.patch(p_mesh, buffers)) {
+			clear_mesh(p_mesh);
+			r.copy_to(p_mesh, buffers);
+		}
+		r.evict();
+
+		if (color_mesh) {
+			shrink_mesh(color_mesh);
+		}
+		r_material = Ref<Material>();
 	}
 
-	Renderer r(tove_mesh, subtree_graphics);
-	r.traverse(p_path, Transform2D());
+	return tove_bounds_to_rect2(p_path->get_tove_path()->getBounds());
+}
 
-	r_material = copy_mesh(p_mesh, tove_mesh, subtree_graphics, r_texture, p_spatial);
+int VGAbstractMeshRenderer::render_batch(Ref<ArrayMesh> &p_mesh, Node *p_root, VGMeshCache &p_cache, VGMeshBuffers &r_buffers, float p_scale) {
+	// batched paths need not share a root path, so there are no common
+	// graphics to clip with; clipped paths stay out of the batch and draw
+	// themselves.
+	static const tove::GraphicsRef no_graphics = tove::tove_make_shared<tove::Graphics>();
 
-	return tove_bounds_to_rect2(p_path->get_tove_path()->getBounds());
+	CachedRenderer r(p_cache, no_graphics, p_scale);
+	r.batching = true;
+	r.traverse(p_root, Transform2D());
+	if (!r.patch(p_mesh, r_buffers)) {
+		clear_mesh(p_mesh);
+		r.copy_to(p_mesh, r_buffers);
+	}
+	r.evict();
+	return r.order.size();
 }
 
 Ref<ImageTexture> VGAbstractMeshRenderer::render_texture(VGPath *p_path, bool p_hq) {
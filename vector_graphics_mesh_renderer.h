@@ -5,11 +5,147 @@
 #ifndef VG_MESH_RENDERER_H
 #define VG_MESH_RENDERER_H
 
+#include "core/object/worker_thread_pool.h"
+#include "core/templates/hash_map.h"
+#include "core/templates/local_vector.h"
 #include "scene/resources/image_texture.h"
 #include "utils.h"
 #include "vector_graphics_renderer.h"
 
+// tessellations of the paths in a VGPath's subtree, kept by the path that
+// renders them so that a change only re-tessellates the paths it touched.
+// geometry is stored in each path's local space; transforms relative to the
+// rendering path are applied when splicing. every path keeps a few levels of
+// detail, one per power-of-two scale bucket.
+struct VGMeshCache {
+	static constexpr int NO_BUCKET = INT32_MIN;
+
+	struct Level {
+		int bucket = NO_BUCKET;
+		uint64_t version = 0;
+		uint64_t color_version = 0;
+		uint64_t used = 0;
+
+		LocalVector<Vector3> vertices;
+		LocalVector<Color> colors;
+		LocalVector<int32_t> indices;
+
+		// the fill and line ranges of `vertices`, to repaint them in place.
+		LocalVector<tove::PaintRange> paint_ranges;
+
+		uint32_t vertex_hash = 0;
+		uint32_t color_hash = 0;
+		uint32_t index_hash = 0;
+	};
+
+	struct Entry {
+		LocalVector<Level> levels;
+		int bucket = NO_BUCKET;
+		uint64_t pass = 0;
+
+		// tesselators with a fixed size get a tove mesh of their own per
+		// path, so its triangulations carry over while the topology holds.
+		tove::MeshRef rigid_mesh;
+		tove::TesselatorRef rigid_tesselator;
+		uint32_t rigid_topology = 0;
+	};
+
+	// a path's tessellation running on the WorkerThreadPool. the worker only
+	// sees the snapshot and writes only `level`.
+	struct Job {
+		tove::PathRef tove_path;
+		tove::GraphicsRef graphics;
+		tove::TesselatorRef tesselator;
+		float scale = 1.0f;
+		Level level;
+		WorkerThreadPool::TaskID task = WorkerThreadPool::INVALID_TASK_ID;
+	};
+
+	// one per path spliced into the last full or partial upload.
+	struct Upload {
+		uint32_t vertex_count = 0;
+		uint32_t index_count = 0;
+		uint32_t vertex_hash = 0;
+		uint32_t color_hash = 0;
+		uint32_t index_hash = 0;
+		Transform2D transform;
+	};
+
+	HashMap<ObjectID, Entry> entries;
+	uint64_t pass = 0;
+	int bucket = NO_BUCKET;
+
+	// what went into `mesh` last time, so that the next render can patch
+	// just the ranges that differ.
+	LocalVector<Upload> uploads;
+	RID mesh;
+
+	HashMap<ObjectID, Job *> jobs;
+
+	bool has_pending_jobs() const {
+		return !jobs.is_empty();
+	}
+	// waits for a path's job, if it has one, and drops it.
+	void finish_job(const ObjectID &p_id);
+
+	~VGMeshCache();
+};
+
+// surface arrays kept between renders. add_surface_from_arrays() copies
+// them into the server, so they are unshared again by the next render and
+// only reallocate when the scene's size changes.
+struct VGMeshBuffers {
+	Vector<Vector3> vertices;
+	Vector<Color> colors;
+	Vector<int> indices;
+	Vector<Vector3> normals;
+	Vector<float> tangents;
+
+	// staging for partial updates.
+	Vector<uint8_t> vertex_region;
+	Vector<uint8_t> color_region;
+
+	uint64_t allocations = 0;
+
+	template <typename T>
+	Error resize_buffer(Vector<T> &r_buffer, int p_size) {
+		const T *before = r_buffer.ptr();
+		const Error err = r_buffer.resize(p_size);
+		if (r_buffer.ptr() != before) {
+			allocations++;
+		}
+		return err;
+	}
+
+	Error resize(int p_vertex_count, int p_index_count);
+	void clear();
+};
+
 class VGAbstractMeshRenderer : public VGRenderer {
+	GDCLASS(VGAbstractMeshRenderer, VGRenderer);
+
+	int lod_cache_size = 3;
+	uint64_t lod_cache_hits = 0;
+	uint64_t lod_cache_misses = 0;
+
+	// tove meshes reused for tessellation. once a render needs less than a
+	// quarter of what they hold, they are shrunk to fit.
+	tove::MeshRef color_mesh;
+	tove::MeshRef paint_mesh;
+	int mesh_peak = 0;
+	bool mesh_acquired = false;
+
+	bool partial_updates = true;
+
+	bool async_tessellation = false;
+	int async_apply_budget = 8;
+	uint64_t async_frame = 0;
+	int async_applied = 0;
+
+	VGMeshBuffers buffers;
+
+	void shrink_mesh(const tove::MeshRef &p_mesh);
+
 protected:
 	tove::TesselatorRef tesselator;
 
@@ -22,12 +158,65 @@ public:
 		return tesselator;
 	}
 
+	// tesselators are stateful; anything tessellating off the main thread
+	// needs its own instance configured like this renderer's.
+	virtual tove::TesselatorRef new_tesselator() const = 0;
+
+	static void tesselate_path(
+			const tove::TesselatorRef &p_tesselator,
+			const tove::GraphicsRef &p_graphics,
+			const tove::PathRef &p_tove_path,
+			float p_scale,
+			const tove::MeshRef &p_tove_mesh,
+			int &r_fill_index,
+			int &r_line_index,
+			ToveMeshUpdateFlags p_update = UPDATE_MESH_EVERYTHING);
+
 	virtual Rect2 render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial = false);
+
+	// splices every mesh-rendered VGPath below p_root into p_mesh, relative
+	// to p_root and with vertex colors only. returns the number of paths.
+	static int render_batch(Ref<ArrayMesh> &p_mesh, Node *p_root, VGMeshCache &p_cache, VGMeshBuffers &r_buffers, float p_scale);
 	virtual Ref<ImageTexture> render_texture(VGPath *p_path, bool p_hq);
 
 	virtual bool is_dirty_on_transform_change() const {
 		return false;
 	}
+
+	// picks the power-of-two bucket nearest to p_scale, but stays in
+	// p_current_bucket until the scale is a quarter octave past its edge.
+	static int select_lod_bucket(float p_scale, int p_current_bucket);
+	static float get_lod_bucket_scale(int p_bucket);
+
+	int get_lod_cache_size() const;
+	void set_lod_cache_size(int p_size);
+
+	void record_lod_cache_lookup(bool p_hit);
+	float get_lod_cache_hit_rate() const;
+	void reset_lod_cache_stats();
+
+	// an empty mesh that keeps the storage of earlier renders.
+	const tove::MeshRef &acquire_mesh(bool p_paint);
+
+	void shrink_buffers();
+	int64_t get_allocation_count() const;
+
+	// keeps the surface while the splice layout and indices are unchanged,
+	// and only rewrites the vertex and color ranges of paths that changed.
+	bool is_partial_updates_enabled() const;
+	void set_partial_updates_enabled(bool p_enabled);
+
+	// re-tessellates changed paths on the WorkerThreadPool and draws their
+	// previous tessellation until the new one is applied, at most
+	// async_apply_budget per frame.
+	bool is_async_tessellation_enabled() const;
+	void set_async_tessellation_enabled(bool p_enabled);
+
+	int get_async_apply_budget() const;
+	void set_async_apply_budget(int p_budget);
+
+	// counts a finished job against this frame's budget; false if spent.
+	bool take_async_result();
 };
 
 #endif // VG_MESH_RENDERER_H
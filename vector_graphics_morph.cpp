@@ -0,0 +1,271 @@
+/*************************************************************************/
+/*  vg_morph.cpp                                                         */
+/*************************************************************************/
+
+#include "vector_graphics_morph.h"
+#include "modules/svg_mesh/thirdparty/tove2d/src/cpp/mesh/meshifier.h"
+#include "servers/rendering_server.h"
+
+// tove interpolates paths whose point counts differ by switching from one
+// to the other at t = 0.5, which changes the mesh's layout.
+static bool is_morph_compatible(const tove::GraphicsRef &p_a, const tove::GraphicsRef &p_b) {
+	const int n = p_a->getNumPaths();
+	if (n != p_b->getNumPaths()) {
+		return false;
+	}
+	for (int i = 0; i < n; i++) {
+		const tove::PathRef &a = p_a->getPath(i);
+		const tove::PathRef &b = p_b->getPath(i);
+		if (a->getNumSubpaths() != b->getNumSubpaths() ||
+				a->getNSVG()->fill.type != b->getNSVG()->fill.type ||
+				a->getNSVG()->stroke.type != b->getNSVG()->stroke.type ||
+				a->getLineJoin() != b->getLineJoin()) {
+			return false;
+		}
+		const int m = a->getNumSubpaths();
+		for (int j = 0; j < m; j++) {
+			const NSVGpath &sa = a->getSubpath(j)->nsvg;
+			const NSVGpath &sb = b->getSubpath(j)->nsvg;
+			if (sa.npts != sb.npts || sa.closed != sb.closed) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+VGMorph::VGMorph() {
+	mesh.instantiate();
+	tesselator = tove::tove_make_shared<tove::RigidTesselator>(subdivisions, TOVE_HOLES_CW);
+}
+
+void VGMorph::load_graphics() {
+	from_graphics = tove::GraphicsRef();
+	to_graphics = tove::GraphicsRef();
+	rebuild = true;
+	dirty = true;
+	queue_redraw();
+
+	if (from_svg.is_empty() || to_svg.is_empty()) {
+		return;
+	}
+
+	tove::GraphicsRef a = load_svg_graphics(from_svg);
+	tove::GraphicsRef b = load_svg_graphics(to_svg);
+	if (!a || !b) {
+		return;
+	}
+	ERR_FAIL_COND_MSG(a->getNumPaths() != b->getNumPaths(), "Cannot morph between SVGs with different path counts.");
+
+	from_graphics = a;
+	to_graphics = b;
+	compatible = is_morph_compatible(a, b);
+	graphics = tove::tove_make_shared<tove::Graphics>();
+}
+
+void VGMorph::update_mesh() {
+	if (!dirty) {
+		return;
+	}
+	dirty = false;
+
+	if (!from_graphics || !to_graphics) {
+		mesh->clear_surfaces();
+		surface_vertex_count = 0;
+		surface_index_count = 0;
+		return;
+	}
+
+	graphics->animate(from_graphics, to_graphics, t);
+
+	ToveMeshUpdateFlags update = UPDATE_MESH_VERTICES | UPDATE_MESH_COLORS | UPDATE_MESH_AUTO_TRIANGLES;
+	if (rebuild || !tove_mesh) {
+		tove_mesh = tove::tove_make_shared<tove::ColorMesh>(tove::VERTEX_LAYOUT_SPLIT);
+		update = UPDATE_MESH_EVERYTHING;
+	}
+	const ToveMeshUpdateFlags updated = tesselator->graphicsToMesh(graphics.get(), update, tove_mesh, tove_mesh);
+
+	const int vertex_count = tove_mesh->getVertexCount();
+	vertices.resize(vertex_count);
+	colors.resize(vertex_count);
+	if (vertex_count > 0) {
+		copy_mesh_vertices(tove_mesh, Vector3(), vertices.ptr(), colors.ptr());
+	}
+
+	if (rebuild || (updated & UPDATE_MESH_TRIANGLES) ||
+			vertex_count != surface_vertex_count ||
+			tove_mesh->getIndexCount() != surface_index_count) {
+		rebuild_surface();
+		return;
+	}
+
+	if (vertex_count == 0) {
+		return;
+	}
+
+	uint8_t *w = vertex_data.ptrw();
+	for (int i = 0; i < vertex_count; i++) {
+		const Vector3 &v = vertices[i];
+		const float p[3] = { float(v.x), float(v.y), float(v.z) };
+		memcpy(w + i * vertex_stride, p, sizeof(p));
+	}
+	mesh->surface_update_vertex_region(0, 0, vertex_data);
+	if (pack_colors()) {
+		mesh->surface_update_attribute_region(0, 0, attribute_data);
+	}
+	vertex_updates++;
+}
+
+void VGMorph::rebuild_surface() {
+	rebuild = false;
+	surface_rebuilds++;
+
+	mesh->clear_surfaces();
+	surface_vertex_count = vertices.size();
+	surface_index_count = tove_mesh->getIndexCount();
+	if (surface_vertex_count == 0 || surface_index_count == 0) {
+		return;
+	}
+
+	Vector<Vector3> varr;
+	Vector<Color> carr;
+	Vector<int> iarr;
+	ERR_FAIL_COND(varr.resize(surface_vertex_count) != OK);
+	ERR_FAIL_COND(carr.resize(surface_vertex_count) != OK);
+	ERR_FAIL_COND(iarr.resize(surface_index_count) != OK);
+	memcpy(varr.ptrw(), vertices.ptr(), surface_vertex_count * sizeof(Vector3));
+	memcpy(carr.ptrw(), colors.ptr(), surface_vertex_count * sizeof(Color));
+	copy_mesh_indices(tove_mesh, 0, iarr.ptrw());
+
+	Array arr;
+	ERR_FAIL_COND(arr.resize(Mesh::ARRAY_MAX) != OK);
+	arr[Mesh::ARRAY_VERTEX] = varr;
+	arr[Mesh::ARRAY_COLOR] = carr;
+	arr[Mesh::ARRAY_INDEX] = iarr;
+	mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr);
+
+	// every t lies between the two states, and so do the vertices; the
+	// aabb doesn't need to follow vertex updates.
+	const float *a = from_graphics->getBounds();
+	const float *b = to_graphics->getBounds();
+	const Rect2 bounds = tove_bounds_to_rect2(a).merge(tove_bounds_to_rect2(b));
+	mesh->set_custom_aabb(AABB(
+			Vector3(bounds.position.x * 0.001f, -bounds.get_end().y * 0.001f, 0),
+			Vector3(bounds.size.x * 0.001f, bounds.size.y * 0.001f, 0)));
+
+	// where the server keeps positions and colors, for region updates.
+	uint32_t offsets[RS::ARRAY_MAX];
+	uint32_t normal_stride;
+	uint32_t skin_stride;
+	RS::get_singleton()->mesh_surface_make_offsets_from_format(
+			uint64_t(mesh->surface_get_format(0)), surface_vertex_count, surface_index_count,
+			offsets, vertex_stride, normal_stride, attribute_stride, skin_stride);
+	color_offset = offsets[RS::ARRAY_COLOR];
+
+	ERR_FAIL_COND(vertex_data.resize(surface_vertex_count * vertex_stride) != OK);
+	ERR_FAIL_COND(attribute_data.resize(surface_vertex_count * attribute_stride) != OK);
+	pack_colors();
+}
+
+bool VGMorph::pack_colors() {
+	bool changed = false;
+	uint8_t *w = attribute_data.ptrw();
+	for (uint32_t i = 0; i < colors.size(); i++) {
+		uint8_t rgba[4];
+		encode_mesh_color(colors[i], rgba);
+		uint8_t *dst = w + i * attribute_stride + color_offset;
+		if (memcmp(dst, rgba, 4) != 0) {
+			memcpy(dst, rgba, 4);
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+void VGMorph::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_DRAW: {
+			update_mesh();
+			if (surface_index_count > 0) {
+				draw_mesh(mesh, Ref<Texture2D>(), Transform2D());
+			}
+		} break;
+	}
+}
+
+String VGMorph::get_from_svg() const {
+	return from_svg;
+}
+
+void VGMorph::set_from_svg(const String &p_path) {
+	from_svg = p_path;
+	load_graphics();
+}
+
+String VGMorph::get_to_svg() const {
+	return to_svg;
+}
+
+void VGMorph::set_to_svg(const String &p_path) {
+	to_svg = p_path;
+	load_graphics();
+}
+
+float VGMorph::get_t() const {
+	return t;
+}
+
+void VGMorph::set_t(float p_t) {
+	p_t = CLAMP(p_t, 0.0f, 1.0f);
+	if (p_t == t) {
+		return;
+	}
+	if (!compatible && (p_t < 0.5f) != (t < 0.5f)) {
+		rebuild = true;
+	}
+	t = p_t;
+	dirty = true;
+	queue_redraw();
+}
+
+int VGMorph::get_subdivisions() const {
+	return subdivisions;
+}
+
+void VGMorph::set_subdivisions(int p_subdivisions) {
+	subdivisions = CLAMP(p_subdivisions, 0, tove::toveMaxFlattenSubdivisions);
+	tesselator = tove::tove_make_shared<tove::RigidTesselator>(subdivisions, TOVE_HOLES_CW);
+	rebuild = true;
+	dirty = true;
+	queue_redraw();
+}
+
+int64_t VGMorph::get_surface_rebuild_count() const {
+	return surface_rebuilds;
+}
+
+int64_t VGMorph::get_vertex_update_count() const {
+	return vertex_updates;
+}
+
+void VGMorph::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_from_svg", "path"), &VGMorph::set_from_svg);
+	ClassDB::bind_method(D_METHOD("get_from_svg"), &VGMorph::get_from_svg);
+
+	ClassDB::bind_method(D_METHOD("set_to_svg", "path"), &VGMorph::set_to_svg);
+	ClassDB::bind_method(D_METHOD("get_to_svg"), &VGMorph::get_to_svg);
+
+	ClassDB::bind_method(D_METHOD("set_t", "t"), &VGMorph::set_t);
+	ClassDB::bind_method(D_METHOD("get_t"), &VGMorph::get_t);
+
+	ClassDB::bind_method(D_METHOD("set_subdivisions", "subdivisions"), &VGMorph::set_subdivisions);
+	ClassDB::bind_method(D_METHOD("get_subdivisions"), &VGMorph::get_subdivisions);
+
+	ClassDB::bind_method(D_METHOD("get_surface_rebuild_count"), &VGMorph::get_surface_rebuild_count);
+	ClassDB::bind_method(D_METHOD("get_vertex_update_count"), &VGMorph::get_vertex_update_count);
+
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "from_svg", PROPERTY_HINT_FILE, "*.svg"), "set_from_svg", "get_from_svg");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "to_svg", PROPERTY_HINT_FILE, "*.svg"), "set_to_svg", "get_to_svg");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "t", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_t", "get_t");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "subdivisions", PROPERTY_HINT_RANGE, "0,6,1"), "set_subdivisions", "get_subdivisions");
+}
@@ -0,0 +1,77 @@
+/*************************************************************************/
+/*  vg_morph.h                                                           */
+/*************************************************************************/
+
+#ifndef VG_MORPH_H
+#define VG_MORPH_H
+
+#include "scene/2d/node_2d.h"
+#include "scene/resources/mesh.h"
+#include "utils.h"
+
+// interpolates between two svg files with compatible topology. both states
+// are flattened rigidly into one persistent mesh, so a new t only moves
+// vertices: cached triangulations are reused when they still fit, and
+// only the vertex buffer (plus colors, if they change) goes to the server.
+class VGMorph : public Node2D {
+	GDCLASS(VGMorph, Node2D);
+
+	String from_svg;
+	String to_svg;
+	float t = 0.0f;
+	int subdivisions = 4;
+
+	tove::GraphicsRef from_graphics;
+	tove::GraphicsRef to_graphics;
+	tove::GraphicsRef graphics;
+	tove::TesselatorRef tesselator;
+	tove::MeshRef tove_mesh;
+	bool compatible = true;
+
+	Ref<ArrayMesh> mesh;
+	int surface_vertex_count = 0;
+	int surface_index_count = 0;
+	uint32_t vertex_stride = 0;
+	uint32_t attribute_stride = 0;
+	uint32_t color_offset = 0;
+
+	LocalVector<Vector3> vertices;
+	LocalVector<Color> colors;
+	Vector<uint8_t> vertex_data;
+	Vector<uint8_t> attribute_data;
+
+	bool dirty = false;
+	bool rebuild = true;
+
+	uint64_t surface_rebuilds = 0;
+	uint64_t vertex_updates = 0;
+
+	void load_graphics();
+	void update_mesh();
+	void rebuild_surface();
+	bool pack_colors();
+
+protected:
+	void _notification(int p_what);
+	static void _bind_methods();
+
+public:
+	String get_from_svg() const;
+	void set_from_svg(const String &p_path);
+
+	String get_to_svg() const;
+	void set_to_svg(const String &p_path);
+
+	float get_t() const;
+	void set_t(float p_t);
+
+	int get_subdivisions() const;
+	void set_subdivisions(int p_subdivisions);
+
+	int64_t get_surface_rebuild_count() const;
+	int64_t get_vertex_update_count() const;
+
+	VGMorph();
+};
+
+#endif // VG_MORPH_H
@@ -32,6 +32,7 @@
 #include "core/io/file_access.h"
 #include "scene/2d/sprite_2d.h"
 #include "vector_graphics_adaptive_renderer.h"
+#include "vector_graphics_batch.h"
 #include "vector_graphics_color.h"
 #include "vector_graphics_linear_gradient.h"
 #include "vector_graphics_radial_gradient.h"
@@ -153,16 +154,10 @@ static Point2 compute_center(const tove::PathRef &p_path) {
 
 void VGPath::import_svg(const String &p_path) {
 
-	String units = "px";
-	float dpi = 96.0;
-
-	Vector<uint8_t> buf = FileAccess::get_file_as_bytes(p_path);
-
-	String str;
-	str.parse_utf8((const char *)buf.ptr(), buf.size());
-
-	tove::GraphicsRef tove_graphics = tove::Graphics::createFromSVG(
-			str.utf8().ptr(), units.utf8().ptr(), dpi);
+	tove::GraphicsRef tove_graphics = load_svg_graphics(p_path);
+	if (!tove_graphics) {
+		return;
+	}
 
 	const float *bounds = tove_graphics->getBounds();
 
@@ -245,6 +240,9 @@ void VGPath::compose_graphics(const tove::GraphicsRef &p_tove_graphics,
 	const int n = p_node->get_child_count();
 	for (int i = 0; i < n; i++) {
 		Node *child = p_node->get_child(i);
+		if (child->is_class_ptr(VGBatch::get_class_ptr_static())) {
+			continue;
+		}
 
 		Transform2D t;
 		if (child->is_class_ptr(CanvasItem::get_class_ptr_static())) {
@@ -267,6 +265,22 @@ bool VGPath::inherits_renderer() const {
 	return renderer.is_null();
 }
 
+bool VGPath::is_batched() const {
+	if (batch_id.is_null()) {
+		return false;
+	}
+	if (!tove_path->getClipIndices().empty()) {
+		// a batch has no root graphics to take the clips from.
+		return false;
+	}
+	Ref<VGRenderer> current_renderer = get_inherited_renderer();
+	return current_renderer.is_valid() && current_renderer->is_class_ptr(VGAbstractMeshRenderer::get_class_ptr_static());
+}
+
+VGBatch *VGPath::get_batch() const {
+	return Object::cast_to<VGBatch>(ObjectDB::get_instance(batch_id));
+}
+
 VGPath *VGPath::get_root_path() {
 	VGPath *root = this;
 	Node *node = get_parent();
@@ -299,10 +313,10 @@ Ref<VGRenderer> VGPath::get_inherited_renderer() const {
 
 void VGPath::update_mesh_representation() {
 
-	if (!dirty) {
+	if (!dirty_flags && !has_pending_tessellation()) {
 		return;
 	}
-	dirty = false;
+	dirty_flags = 0;
 
 	if (!is_empty()) {
 		Ref<VGRenderer> current_renderer = get_inherited_renderer();
@@ -315,12 +329,19 @@ void VGPath::update_mesh_representation() {
 	}
 }
 
-void VGPath::update_tove_fill_color() {
+// the tesselator only emits fill triangles for a present fill and stroke
+// geometry for a solid stroke, so a change of paint type needs a new mesh,
+// while a change of value within the same type is only a recolor.
+uint32_t VGPath::update_tove_fill_color() {
+	const char old_type = tove_path->getNSVG()->fill.type;
 	tove_path->setFillColor(to_tove_paint(fill_color));
+	return tove_path->getNSVG()->fill.type == old_type ? DIRTY_COLOR : DIRTY_GEOMETRY | DIRTY_COLOR;
 }
 
-void VGPath::update_tove_line_color() {
+uint32_t VGPath::update_tove_line_color() {
+	const char old_type = tove_path->getNSVG()->stroke.type;
 	tove_path->setLineColor(to_tove_paint(line_color));
+	return tove_path->getNSVG()->stroke.type == old_type ? DIRTY_COLOR : DIRTY_GEOMETRY | DIRTY_COLOR;
 }
 
 void VGPath::create_fill_color() {
@@ -352,6 +373,20 @@ void VGPath::_transform_changed(Node *p_node) {
 		Ref<VGRenderer> renderer = path->get_inherited_renderer();
 		if (renderer.is_valid() && renderer->is_dirty_on_transform_change()) {
 			path->set_dirty();
+		} else if (path->mesh_cache && path->mesh_cache->pass > 0) {
+			// moving, rotating and moderate zooming reuse the tessellation;
+			// only a scale that moves to another lod bucket needs a new one.
+			const Size2 s = path->get_global_transform().get_scale();
+			const int bucket = path->mesh_cache->bucket;
+			if (VGAbstractMeshRenderer::select_lod_bucket(MAX(s.width, s.height), bucket) != bucket) {
+				path->mark_dirty(DIRTY_TRANSFORM);
+			}
+		}
+
+		// the batch holds the path's transform relative to it.
+		VGBatch *batch = path->get_batch();
+		if (batch) {
+			batch->queue_redraw();
 		}
 	}
 
@@ -366,10 +401,44 @@ void VGPath::_notification(int p_what) {
 
 	switch (p_what) {
 		case NOTIFICATION_DRAW: {
+			if (is_batched()) {
+				break;
+			}
 			update_mesh_representation();
 			if (!is_empty()) {
 				draw_mesh(mesh, texture, Transform2D());
 			}
+			if (has_pending_tessellation()) {
+				// look for the results again next frame.
+				set_process_internal(true);
+			}
+		} break;
+		case NOTIFICATION_INTERNAL_PROCESS: {
+			set_process_internal(false);
+			queue_redraw();
+		} break;
+		case NOTIFICATION_ENTER_TREE: {
+			Node *node = get_parent();
+			while (node && !node->is_class_ptr(VGBatch::get_class_ptr_static())) {
+				node = node->get_parent();
+			}
+			if (node) {
+				batch_id = node->get_instance_id();
+				Object::cast_to<VGBatch>(node)->queue_redraw();
+			}
+		} break;
+		case NOTIFICATION_VISIBILITY_CHANGED: {
+			VGBatch *batch = get_batch();
+			if (batch) {
+				batch->queue_redraw();
+			}
+		} break;
+		case NOTIFICATION_EXIT_TREE: {
+			VGBatch *batch = get_batch();
+			if (batch) {
+				batch->queue_redraw();
+			}
+			batch_id = ObjectID();
 		} break;
 		case NOTIFICATION_PARENTED: {
 			_bubble_change();
@@ -405,7 +474,7 @@ void VGPath::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_line_width", "width"), &VGPath::set_line_width);
 	ClassDB::bind_method(D_METHOD("get_line_width"), &VGPath::get_line_width);
 
-	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "renderer", PROPERTY_HINT_RESOURCE_TYPE, "VGMeshRenderer"), "set_renderer", "get_renderer");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "renderer", PROPERTY_HINT_RESOURCE_TYPE, "VGAbstractMeshRenderer"), "set_renderer", "get_renderer");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "fill_color", PROPERTY_HINT_RESOURCE_TYPE, "VGColor", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_EDITOR_INSTANTIATE_OBJECT), "set_fill_color", "get_fill_color");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "line_color", PROPERTY_HINT_RESOURCE_TYPE, "VGColor", PROPERTY_USAGE_DEFAULT | PROPERTY_USAGE_EDITOR_INSTANTIATE_OBJECT), "set_line_color", "get_line_color");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "line_width", PROPERTY_HINT_RANGE, "0,100,0.01"), "set_line_width", "get_line_width");
@@ -567,8 +636,7 @@ void VGPath::set_fill_color(const Ref<VGPaint> &p_paint) {
 
 	fill_color = p_paint;
 
-	update_tove_fill_color();
-	set_dirty();
+	mark_dirty(update_tove_fill_color());
 }
 
 Ref<VGPaint> VGPath::get_line_color() const {
@@ -580,8 +648,7 @@ void VGPath::set_line_color(const Ref<VGPaint> &p_paint) {
 		return;
 	}
 	line_color = p_paint;
-	update_tove_line_color();
-	set_dirty();
+	mark_dirty(update_tove_line_color());
 }
 
 float VGPath::get_line_width() const {
@@ -590,7 +657,7 @@ float VGPath::get_line_width() const {
 
 void VGPath::set_line_width(const float p_line_width) {
 	tove_path->setLineWidth(p_line_width);
-	set_dirty();
+	mark_dirty(DIRTY_LINE_WIDTH);
 }
 
 bool VGPath::is_inside(const Point2 &p_point) const {
@@ -632,13 +699,11 @@ void VGPath::_edit_set_position(const Point2 &p_position) {
 
 void VGPath::_changed_callback(Object *p_changed, const char *p_prop) {
 	if (fill_color.ptr() == p_changed) {
-		update_tove_fill_color();
-		set_dirty();
+		mark_dirty(update_tove_fill_color());
 	}
 
 	if (line_color.ptr() == p_changed) {
-		update_tove_line_color();
-		set_dirty();
+		mark_dirty(update_tove_line_color());
 	}
 }
 #endif
@@ -678,16 +743,48 @@ void VGPath::set_dirty(bool p_children) {
 		return;
 	}
 
-	Node *node = this;
-	while (node) {
-		if (node->is_class_ptr(get_class_ptr_static())) {
-			Object::cast_to<VGPath>(node)->subtree_graphics = tove::GraphicsRef();
+	mark_dirty(DIRTY_ALL);
+}
+
+void VGPath::mark_dirty(uint32_t p_flags) {
+	if (p_flags & ~DIRTY_TRANSFORM) {
+		Node *node = this;
+		while (node) {
+			if (node->is_class_ptr(get_class_ptr_static())) {
+				Object::cast_to<VGPath>(node)->subtree_graphics = tove::GraphicsRef();
+			}
+			node = node->get_parent();
 		}
-		node = node->get_parent();
 	}
 
-	dirty = true;
-	notify_property_list_changed();
+	if (p_flags & (DIRTY_GEOMETRY | DIRTY_LINE_WIDTH)) {
+		version++;
+	}
+	if (p_flags & DIRTY_COLOR) {
+		color_version++;
+	}
+
+	dirty_flags |= p_flags;
+	if (p_flags & ~DIRTY_TRANSFORM) {
+		notify_property_list_changed();
+	}
+	queue_redraw();
+
+	VGBatch *batch = get_batch();
+	if (batch) {
+		batch->queue_redraw();
+	}
+}
+
+bool VGPath::has_pending_tessellation() const {
+	return mesh_cache && mesh_cache->has_pending_jobs();
+}
+
+VGMeshCache &VGPath::get_mesh_cache() {
+	if (!mesh_cache) {
+		mesh_cache = memnew(VGMeshCache);
+	}
+	return *mesh_cache;
 }
 
 bool VGPath::is_empty() const {
@@ -793,6 +890,9 @@ VGPath::VGPath(tove::PathRef p_path) {
 }
 
 VGPath::~VGPath() {
+	if (mesh_cache) {
+		memdelete(mesh_cache);
+	}
 }
 
 VGPath *VGPath::create_from_svg(Ref<Resource> p_resource) {
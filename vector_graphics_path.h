@@ -10,16 +10,36 @@
 #include "vector_graphics_paint.h"
 #include "vector_graphics_renderer.h"
 
+struct VGMeshCache;
+class VGBatch;
+
 class VGPath : public Node2D {
 	GDCLASS(VGPath, Node2D);
 
+public:
+	// what changed since the last draw. geometry and line width need a new
+	// tessellation, colors only repaint the cached one and a transform only
+	// matters if it moves the path to another lod bucket.
+	enum DirtyFlags {
+		DIRTY_GEOMETRY = 1,
+		DIRTY_COLOR = 2,
+		DIRTY_LINE_WIDTH = 4,
+		DIRTY_TRANSFORM = 8,
+		DIRTY_ALL = 15,
+	};
+
+private:
 	Transform2D vg_transform;
 	tove::PathRef tove_path;
 	Ref<ArrayMesh> mesh;
 	Ref<Texture> texture;
 
 	mutable tove::GraphicsRef subtree_graphics;
-	bool dirty;
+	uint32_t dirty_flags = DIRTY_ALL;
+	uint64_t version = 0;
+	uint64_t color_version = 0;
+	VGMeshCache *mesh_cache = nullptr;
+	ObjectID batch_id;
 
 	Ref<VGPaint> fill_color;
 	Ref<VGPaint> line_color;
@@ -31,13 +51,14 @@ class VGPath : public Node2D {
 	static void _transform_changed(Node *p_node);
 
 	bool inherits_renderer() const;
+	bool is_batched() const;
 
 	tove::GraphicsRef create_tove_graphics() const;
 	void add_tove_path(const tove::GraphicsRef &p_tove_graphics) const;
 	void update_mesh_representation();
 
-	void update_tove_fill_color();
-	void update_tove_line_color();
+	uint32_t update_tove_fill_color();
+	uint32_t update_tove_line_color();
 	void create_fill_color();
 	void create_line_color();
 
@@ -61,6 +82,7 @@ public:
 #endif
 
 	VGPath *get_root_path();
+	VGBatch *get_batch() const;
 	Ref<VGRenderer> get_inherited_renderer() const;
 
 	Ref<VGRenderer> get_renderer();
@@ -88,6 +110,21 @@ public:
 	tove::GraphicsRef get_subtree_graphics() const;
 
 	void set_dirty(bool p_children = false);
+	void mark_dirty(uint32_t p_flags);
+	uint32_t get_dirty_flags() const {
+		return dirty_flags;
+	}
+	// bumped by changes to geometry or line width.
+	uint64_t get_version() const {
+		return version;
+	}
+	// bumped by changes to fill or line paint.
+	uint64_t get_color_version() const {
+		return color_version;
+	}
+	VGMeshCache &get_mesh_cache();
+	// whether tessellations for this path's mesh are still running.
+	bool has_pending_tessellation() const;
 	void set_tove_path(tove::PathRef p_path);
 	void recenter();
 
@@ -0,0 +1,67 @@
+/*************************************************************************/
+/*  vg_rigid_renderer.cpp                                                */
+/*************************************************************************/
+
+#include "vector_graphics_rigid_renderer.h"
+#include "modules/svg_mesh/thirdparty/tove2d/src/cpp/mesh/meshifier.h"
+
+VGRigidMeshRenderer::VGRigidMeshRenderer() :
+		subdivisions(4),
+		holes(HOLES_CW) {
+	create_tesselator();
+}
+
+void VGRigidMeshRenderer::create_tesselator() {
+	tesselator = new_tesselator();
+}
+
+tove::TesselatorRef VGRigidMeshRenderer::new_tesselator() const {
+	ToveHoles tove_holes;
+	switch (holes) {
+		case HOLES_NONE:
+			tove_holes = TOVE_HOLES_NONE;
+			break;
+		case HOLES_CCW:
+			tove_holes = TOVE_HOLES_CCW;
+			break;
+		default:
+			tove_holes = TOVE_HOLES_CW;
+			break;
+	}
+	return tove::tove_make_shared<tove::RigidTesselator>(subdivisions, tove_holes);
+}
+
+int VGRigidMeshRenderer::get_subdivisions() const {
+	return subdivisions;
+}
+
+void VGRigidMeshRenderer::set_subdivisions(int p_subdivisions) {
+	subdivisions = CLAMP(p_subdivisions, 0, tove::toveMaxFlattenSubdivisions);
+	create_tesselator();
+	emit_changed();
+}
+
+VGRigidMeshRenderer::Holes VGRigidMeshRenderer::get_holes() const {
+	return holes;
+}
+
+void VGRigidMeshRenderer::set_holes(Holes p_holes) {
+	holes = p_holes;
+	create_tesselator();
+	emit_changed();
+}
+
+void VGRigidMeshRenderer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_subdivisions", "subdivisions"), &VGRigidMeshRenderer::set_subdivisions);
+	ClassDB::bind_method(D_METHOD("get_subdivisions"), &VGRigidMeshRenderer::get_subdivisions);
+
+	ClassDB::bind_method(D_METHOD("set_holes", "holes"), &VGRigidMeshRenderer::set_holes);
+	ClassDB::bind_method(D_METHOD("get_holes"), &VGRigidMeshRenderer::get_holes);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "subdivisions", PROPERTY_HINT_RANGE, "0,6,1"), "set_subdivisions", "get_subdivisions");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "holes", PROPERTY_HINT_ENUM, "None,Clockwise,Counter-Clockwise"), "set_holes", "get_holes");
+
+	BIND_ENUM_CONSTANT(HOLES_NONE);
+	BIND_ENUM_CONSTANT(HOLES_CW);
+	BIND_ENUM_CONSTANT(HOLES_CCW);
+}
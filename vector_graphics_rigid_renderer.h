@@ -0,0 +1,47 @@
+/*************************************************************************/
+/*  vg_rigid_renderer.h                                                  */
+/*************************************************************************/
+
+#ifndef VG_RIGID_RENDERER_H
+#define VG_RIGID_RENDERER_H
+
+#include "vector_graphics_mesh_renderer.h"
+
+// flattens every curve into a fixed number of segments, independent of
+// scale. as long as a path keeps its topology, its vertices are updated in
+// place and earlier triangulations are reused when they still fit, which
+// suits animation. clip paths are ignored.
+class VGRigidMeshRenderer : public VGAbstractMeshRenderer {
+	GDCLASS(VGRigidMeshRenderer, VGAbstractMeshRenderer);
+
+public:
+	enum Holes {
+		HOLES_NONE,
+		HOLES_CW,
+		HOLES_CCW,
+	};
+
+private:
+	int subdivisions;
+	Holes holes;
+
+protected:
+	void create_tesselator();
+
+	static void _bind_methods();
+
+public:
+	VGRigidMeshRenderer();
+
+	virtual tove::TesselatorRef new_tesselator() const override;
+
+	int get_subdivisions() const;
+	void set_subdivisions(int p_subdivisions);
+
+	Holes get_holes() const;
+	void set_holes(Holes p_holes);
+};
+
+VARIANT_ENUM_CAST(VGRigidMeshRenderer::Holes);
+
+#endif // VG_RIGID_RENDERER_H